@@ -0,0 +1,230 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include "HorizonCuller.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include "simd.h"
+
+namespace {
+struct Footprint {
+    double angle_begin; // the azimuth interval covered by the footprint, angle_end - angle_begin < pi
+    double angle_end;
+    double distance_min; // horizontal distances to the nearest and farthest point
+    double distance_max;
+};
+
+// returns nothing if the camera is inside (or on the border of) the footprint
+std::optional<Footprint> footprint(const radix::geometry::Aabb<3, double>& box, const glm::dvec2& camera)
+{
+    const auto rect = radix::geometry::Aabb<2, double> { glm::dvec2(box.min), glm::dvec2(box.max) };
+    const auto distance_min = std::sqrt(radix::geometry::distance_sq(rect, camera));
+    if (!(distance_min > 0))
+        return {};
+
+    const auto centre = rect.centre() - camera;
+    const auto centre_angle = std::atan2(centre.y, centre.x);
+    const auto corners = std::array { rect.min, glm::dvec2(rect.max.x, rect.min.y), rect.max, glm::dvec2(rect.min.x, rect.max.y) };
+    double delta_min = 0;
+    double delta_max = 0;
+    double distance_max = 0;
+    for (const auto& corner : corners) {
+        const auto v = corner - camera;
+        auto delta = std::atan2(v.y, v.x) - centre_angle;
+        if (delta > glm::pi<double>())
+            delta -= 2 * glm::pi<double>();
+        if (delta < -glm::pi<double>())
+            delta += 2 * glm::pi<double>();
+        delta_min = std::min(delta_min, delta);
+        delta_max = std::max(delta_max, delta);
+        distance_max = std::max(distance_max, glm::length(v));
+    }
+    return Footprint { centre_angle + delta_min, centre_angle + delta_max, distance_min, distance_max };
+}
+
+// the footprints and slopes (as in HorizonCuller::is_hidden) of a batch of boxes, in structure of arrays layout.
+// distance_min is 0 if the camera is inside the footprint.
+template <typename Batch>
+struct Footprints {
+    std::array<double, Batch::width> angle_begin;
+    std::array<double, Batch::width> angle_end;
+    std::array<double, Batch::width> distance_min;
+    std::array<double, Batch::width> slope;
+};
+
+// the same computation as footprint(), on Batch::width boxes at once
+template <typename Batch>
+void footprints(std::span<const radix::geometry::Aabb<3, double>> boxes, const glm::dvec3& camera, Footprints<Batch>* out)
+{
+    constexpr auto width = Batch::width;
+    assert(boxes.size() == width);
+    std::array<double, width> min_x;
+    std::array<double, width> min_y;
+    std::array<double, width> max_x;
+    std::array<double, width> max_y;
+    std::array<double, width> max_z;
+    for (size_t l = 0; l < width; ++l) {
+        min_x[l] = boxes[l].min.x;
+        min_y[l] = boxes[l].min.y;
+        max_x[l] = boxes[l].max.x;
+        max_y[l] = boxes[l].max.y;
+        max_z[l] = boxes[l].max.z;
+    }
+    const auto zero = Batch::broadcast(0);
+    const auto pi = Batch::broadcast(glm::pi<double>());
+    const auto two_pi = Batch::broadcast(2 * glm::pi<double>());
+    const auto camera_x = Batch::broadcast(camera.x);
+    const auto camera_y = Batch::broadcast(camera.y);
+    // the corners relative to the camera
+    const auto x0 = Batch::load(min_x.data()) - camera_x;
+    const auto y0 = Batch::load(min_y.data()) - camera_y;
+    const auto x1 = Batch::load(max_x.data()) - camera_x;
+    const auto y1 = Batch::load(max_y.data()) - camera_y;
+
+    const auto dx = max(max(x0, zero - x1), zero);
+    const auto dy = max(max(y0, zero - y1), zero);
+    const auto distance_min = sqrt(dx * dx + dy * dy);
+    const auto half = Batch::broadcast(0.5);
+    const auto centre_angle = radix::simd::atan2((y0 + y1) * half, (x0 + x1) * half);
+    auto delta_min = zero;
+    auto delta_max = zero;
+    auto distance_max = zero;
+    for (const auto& [x, y] : { std::pair(x0, y0), std::pair(x1, y0), std::pair(x1, y1), std::pair(x0, y1) }) {
+        auto delta = radix::simd::atan2(y, x) - centre_angle;
+        delta = select(delta > pi, delta - two_pi, delta);
+        delta = select(delta < zero - pi, delta + two_pi, delta);
+        delta_min = min(delta_min, delta);
+        delta_max = max(delta_max, delta);
+        distance_max = max(distance_max, sqrt(x * x + y * y));
+    }
+    const auto height = Batch::load(max_z.data()) - Batch::broadcast(camera.z);
+    const auto slope = select(height > zero, height / distance_min, height / distance_max);
+
+    (centre_angle + delta_min).store(out->angle_begin.data());
+    (centre_angle + delta_max).store(out->angle_end.data());
+    distance_min.store(out->distance_min.data());
+    slope.store(out->slope.data());
+}
+
+unsigned wrap(long bin, unsigned n_bins)
+{
+    const auto n = long(n_bins);
+    return unsigned(((bin % n) + n) % n);
+}
+
+void insert(std::vector<radix::HorizonCuller::Step>& steps, const radix::HorizonCuller::Step& step)
+{
+    const auto by_distance = [](const auto& a, const auto& b) { return a.distance < b.distance; };
+    auto pos = std::lower_bound(steps.begin(), steps.end(), step, by_distance);
+    // dominated by a step that is closer (or equally far) and at least as high
+    if (pos != steps.begin() && std::prev(pos)->slope >= step.slope)
+        return;
+    if (pos != steps.end() && pos->distance == step.distance && pos->slope >= step.slope)
+        return;
+    // remove the steps that are dominated by the new one
+    auto end = pos;
+    while (end != steps.end() && end->slope <= step.slope)
+        ++end;
+    pos = steps.erase(pos, end);
+    steps.insert(pos, step);
+}
+} // namespace
+
+namespace radix {
+
+HorizonCuller::HorizonCuller(const glm::dvec3& camera_position, unsigned n_bins)
+    : m_camera_position(camera_position)
+    , m_bin_width(2 * glm::pi<double>() / n_bins)
+    , m_bins(n_bins)
+{
+    assert(n_bins > 0);
+}
+
+void HorizonCuller::add_occluder(const geometry::Aabb<3, double>& box)
+{
+    const auto f = footprint(box, glm::dvec2(m_camera_position));
+    if (!f)
+        return;
+    // every ray in a completely covered bin passes over the footprint somewhere between distance_min and distance_max.
+    // rays with a slope below height / distance at some point of that interval are blocked, the bound is chosen for
+    // the worst case point.
+    const auto height = box.min.z - m_camera_position.z;
+    const auto slope = height > 0 ? height / f->distance_max : height / f->distance_min;
+
+    const auto first = long(std::ceil(f->angle_begin / m_bin_width));
+    const auto last = long(std::floor(f->angle_end / m_bin_width)); // exclusive, bin i covers [i, i + 1) * m_bin_width
+    for (auto bin = first; bin < last; ++bin)
+        insert(m_bins[wrap(bin, n_bins())], { f->distance_max, slope });
+}
+
+double HorizonCuller::horizon(unsigned bin, double distance) const
+{
+    // the highest step that is strictly closer than distance. slopes increase with the distance.
+    const auto& steps = m_bins[bin];
+    const auto pos = std::lower_bound(steps.begin(), steps.end(), distance, [](const Step& step, double d) { return step.distance < d; });
+    if (pos == steps.begin())
+        return -std::numeric_limits<double>::infinity();
+    return std::prev(pos)->slope;
+}
+
+bool HorizonCuller::is_hidden(const geometry::Aabb<3, double>& box) const
+{
+    const auto f = footprint(box, glm::dvec2(m_camera_position));
+    if (!f)
+        return false;
+    // the steepest slope from the camera to any point of the box
+    const auto height = box.max.z - m_camera_position.z;
+    const auto slope = height > 0 ? height / f->distance_min : height / f->distance_max;
+    return is_below_horizon(f->angle_begin, f->angle_end, f->distance_min, slope);
+}
+
+void HorizonCuller::is_hidden(std::span<const geometry::Aabb<3, double>> boxes, std::span<bool> out) const
+{
+    assert(boxes.size() == out.size());
+    using Batch = simd::Batch<double>;
+    constexpr auto width = Batch::width;
+    const auto n_simd = boxes.size() - boxes.size() % width;
+    Footprints<Batch> f;
+    for (size_t i = 0; i < n_simd; i += width) {
+        footprints(boxes.subspan(i, width), m_camera_position, &f);
+        for (size_t l = 0; l < width; ++l)
+            out[i + l] = f.distance_min[l] > 0 && is_below_horizon(f.angle_begin[l], f.angle_end[l], f.distance_min[l], f.slope[l]);
+    }
+    for (size_t i = n_simd; i < boxes.size(); ++i)
+        out[i] = is_hidden(boxes[i]);
+}
+
+bool HorizonCuller::is_below_horizon(double angle_begin, double angle_end, double distance_min, double slope) const
+{
+    const auto first = long(std::floor(angle_begin / m_bin_width));
+    const auto last = long(std::floor(angle_end / m_bin_width)); // inclusive
+    for (auto bin = first; bin <= last; ++bin) {
+        if (!(slope < horizon(wrap(bin, n_bins()), distance_min)))
+            return false;
+    }
+    return true;
+}
+
+} // namespace radix
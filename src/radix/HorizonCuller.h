@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "TileHeights.h"
+#include "geometry.h"
+#include "quad_tree.h"
+#include "tile.h"
+
+namespace radix {
+
+// Conservative horizon (occlusion) culling for terrain tiles, seen from a camera close to the ground.
+//
+// Occluders are boxes whose footprint is solid terrain up to box.min.z (which is true for tile bounds, as the terrain
+// is never lower than the tile's minimum height). The horizon is stored in azimuth bins around the camera. Each bin
+// holds a staircase of (distance, slope) steps: everything further away than distance (horizontally), with an
+// elevation slope (height difference / horizontal distance) below slope, is hidden. An occluder is only entered into
+// bins that it covers completely, and its slope and distance are bounded using its nearest and farthest footprint
+// points, so the result of is_hidden() is either "definitely hidden" (true) or "maybe visible" (false).
+//
+// Coordinates are a projected srs (e.g., web mercator) with heights as z. Earth curvature is ignored, which is
+// conservative (it would hide more).
+class HorizonCuller {
+public:
+    struct Step {
+        double distance;
+        double slope;
+    };
+
+    explicit HorizonCuller(const glm::dvec3& camera_position, unsigned n_bins = 1024);
+
+    void add_occluder(const geometry::Aabb<3, double>& box);
+
+    /// adds tile bounds as occluders. tiles are refined down to zoom_level within max_distance (horizontally) of the
+    /// camera, coarser tiles are used further away. srs_bounds(tile::Id) -> tile::SrsBounds
+    template <typename SrsBoundsFunction>
+    void add_occluders(const TileHeights& heights, const SrsBoundsFunction& srs_bounds, unsigned zoom_level, double max_distance,
+        const tile::Id& root = { 0, { 0, 0 } })
+    {
+        const auto camera = glm::dvec2(m_camera_position);
+        const auto max_distance_sq = max_distance * max_distance;
+        const auto refine = [&](const tile::Id& id) {
+            return id.zoom_level < zoom_level && geometry::distance_sq(geometry::Aabb<2, double>(srs_bounds(id)), camera) < max_distance_sq;
+        };
+        const auto generate_children = [](const tile::Id& id) { return id.children(); };
+        for (const auto& id : quad_tree::onTheFlyTraverse(root, refine, generate_children)) {
+            const geometry::Aabb<2, double> bounds = srs_bounds(id);
+            const auto [min_height, max_height] = heights.query(id);
+            add_occluder({ glm::dvec3(bounds.min, min_height), glm::dvec3(bounds.max, max_height) });
+        }
+    }
+
+    /// true if the box is definitely hidden behind the occluders, false if it may be visible.
+    [[nodiscard]] bool is_hidden(const geometry::Aabb<3, double>& box) const;
+    /// batched version, out must have the same size as boxes. the footprints are computed with simd batches, the
+    /// results agree with the single box version up to the rounding of the azimuths at bin borders.
+    void is_hidden(std::span<const geometry::Aabb<3, double>> boxes, std::span<bool> out) const;
+
+    [[nodiscard]] const glm::dvec3& camera_position() const { return m_camera_position; }
+    [[nodiscard]] unsigned n_bins() const { return unsigned(m_bins.size()); }
+    /// the staircase of a bin, sorted by distance, slopes are strictly increasing.
+    [[nodiscard]] const std::vector<Step>& steps(unsigned bin) const { return m_bins[bin]; }
+
+private:
+    [[nodiscard]] double horizon(unsigned bin, double distance) const;
+    /// true if slope is below the horizon at distance_min in all bins touched by the azimuth interval.
+    [[nodiscard]] bool is_below_horizon(double angle_begin, double angle_end, double distance_min, double slope) const;
+
+    glm::dvec3 m_camera_position;
+    double m_bin_width;
+    std::vector<std::vector<Step>> m_bins;
+};
+
+} // namespace radix
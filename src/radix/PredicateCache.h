@@ -0,0 +1,103 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "tile.h"
+
+namespace radix {
+
+// Memoises a tile refinement predicate (e.g., screen space error) across frames.
+// A cached result is reused as long as the camera moved at most max_camera_delta since it was computed.
+// It's the caller's responsibility to choose max_camera_delta such that the decision can't flip within that distance
+// (e.g., derived from the error threshold and the tile's distance). Predicates that depend on the view direction
+// (frustum tests) should not be cached this way.
+//
+// usage:
+//     PredicateCache cache(lod_predicate, 10.0);
+//     // every frame:
+//     cache.set_camera_position(camera.position());
+//     quad_tree::onTheFlyTraverse(root, cache.predicate(), generate_children);
+template <typename Predicate>
+class PredicateCache {
+    struct Entry {
+        glm::dvec3 camera_position;
+        bool result;
+    };
+    Predicate m_predicate;
+    double m_max_camera_delta_sq;
+    glm::dvec3 m_camera_position = {};
+    tile::IdMap<Entry> m_entries;
+    size_t m_n_evaluations = 0;
+
+public:
+    PredicateCache(Predicate predicate, double max_camera_delta)
+        : m_predicate(std::move(predicate))
+        , m_max_camera_delta_sq(max_camera_delta * max_camera_delta)
+    {
+    }
+
+    void set_camera_position(const glm::dvec3& position) { m_camera_position = position; }
+    [[nodiscard]] const glm::dvec3& camera_position() const { return m_camera_position; }
+
+    bool operator()(const tile::Id& id)
+    {
+        auto iter = m_entries.find(id);
+        if (iter != m_entries.end() && is_valid(iter->second))
+            return iter->second.result;
+
+        ++m_n_evaluations;
+        const bool result = m_predicate(id);
+        if (iter != m_entries.end())
+            iter->second = { m_camera_position, result };
+        else
+            m_entries.emplace(id, Entry { m_camera_position, result });
+        return result;
+    }
+
+    /// returns a callable suitable for quad_tree::onTheFlyTraverse and quad_tree::refine (they take predicates by const ref).
+    [[nodiscard]] auto predicate()
+    {
+        return [this](const tile::Id& id) { return (*this)(id); };
+    }
+
+    /// removes entries that can't be reused from the current camera position anymore.
+    void prune()
+    {
+        std::erase_if(m_entries, [this](const auto& item) { return !is_valid(item.second); });
+    }
+    void clear() { m_entries.clear(); }
+    [[nodiscard]] size_t size() const { return m_entries.size(); }
+    /// number of calls to the wrapped predicate so far (for statistics and tests).
+    [[nodiscard]] size_t n_evaluations() const { return m_n_evaluations; }
+
+private:
+    [[nodiscard]] bool is_valid(const Entry& entry) const
+    {
+        const auto delta = entry.camera_position - m_camera_position;
+        return glm::dot(delta, delta) <= m_max_camera_delta_sq;
+    }
+};
+
+} // namespace radix
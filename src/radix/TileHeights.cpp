@@ -21,6 +21,8 @@
 
 #include "TileHeights.h"
 
+#include "height_encoding.h"
+
 namespace {
 radix::TileHeights::KeyType key(const radix::tile::Id& tile_id)
 {
@@ -58,6 +60,15 @@ void TileHeights::emplace(const tile::Id& tile_id, const std::pair<float, float>
     m_data[key(tile_id)] = min_max;
 }
 
+TileHeights::ValueType TileHeights::emplace(const tile::Descriptor& tile, std::span<const glm::u8vec3> rgb, std::span<float> heights)
+{
+    assert(tile.gridSize <= tile.tileSize && tile.tileSize <= tile.gridSize + unsigned(tile::Border::Yes));
+    assert(rgb.size() == size_t(tile.tileSize) * tile.tileSize);
+    const auto min_max = height_encoding::decode_min_max(rgb, heights);
+    emplace(tile.id, min_max);
+    return min_max;
+}
+
 TileHeights::ValueType TileHeights::query(tile::Id tile_id) const
 {
     while (tile_id.zoom_level > m_max_zoom_level)
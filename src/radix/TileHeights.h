@@ -20,9 +20,12 @@
 
 #include <cstddef>
 #include <filesystem>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
+#include <glm/glm.hpp>
+
 #include "hasher.h"
 #include "tile.h"
 
@@ -41,6 +44,10 @@ private:
 public:
     TileHeights();
     void emplace(const tile::Id& tile_id, const std::pair<float, float>& min_max);
+    /// decodes a height tile (tileSize x tileSize, see height_encoding) and records its min / max in a single pass.
+    /// the border samples (if any) are included, they are inside the descriptor's bounds. heights receives the decoded
+    /// tile, or is empty if only min / max are needed.
+    ValueType emplace(const tile::Descriptor& tile, std::span<const glm::u8vec3> rgb, std::span<float> heights = {});
     [[nodiscard]] ValueType query(tile::Id tile_id) const;
     void write_to(const std::filesystem::path& path) const;
     [[nodiscard]] static TileHeights read_from(const std::filesystem::path& path);
@@ -0,0 +1,253 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include "TileSet.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+// a tile as its zoom level and Morton code on that level
+struct Node {
+    unsigned zoom_level;
+    uint64_t code;
+};
+
+// the tiles in quad tree (pre-order Morton) order, without tiles that are covered by an ancestor in the set
+std::vector<Node> uncovered_in_quad_tree_order(const radix::TileSet& set)
+{
+    using radix::tile::max_key_zoom_level;
+    std::vector<uint64_t> keys;
+    keys.reserve(set.size());
+    for (const auto& id : set)
+        keys.push_back(radix::tile::to_key(id, radix::tile::KeyOrder::QuadTree));
+    radix::radix_sort(std::span(keys));
+
+    std::vector<Node> nodes;
+    nodes.reserve(keys.size());
+    uint64_t covered_end = 0; // end of the last kept tile on max_key_zoom_level
+    for (const auto key : keys) {
+        const auto zoom_level = unsigned(key & 0x3F);
+        const auto first_leaf = key >> 6;
+        if (!nodes.empty() && first_leaf < covered_end)
+            continue;
+        const auto shift = 2 * (max_key_zoom_level - zoom_level);
+        nodes.push_back({ zoom_level, first_leaf >> shift });
+        covered_end = first_leaf + (uint64_t(1) << shift);
+    }
+    return nodes;
+}
+} // namespace
+
+namespace radix {
+
+TileSet::TileSet(tile::Scheme scheme)
+    : m_scheme(scheme)
+{
+}
+
+TileSet::TileSet(std::span<const tile::Id> ids, unsigned n_threads)
+    : m_scheme(ids.empty() ? tile::Scheme::Tms : ids.front().scheme)
+{
+    m_keys.resize(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+        m_keys[i] = key(ids[i]);
+    radix_sort(std::span(m_keys), n_threads);
+    m_keys.erase(std::unique(m_keys.begin(), m_keys.end()), m_keys.end());
+    m_n_sorted = m_keys.size();
+}
+
+TileSet::TileSet(const tile::IdSet& ids, tile::Scheme scheme)
+    : m_scheme(scheme)
+{
+    m_keys.reserve(ids.size());
+    for (const auto& id : ids)
+        m_keys.push_back(key(id));
+    normalise();
+}
+
+uint64_t TileSet::key(const tile::Id& id) const { return tile::to_key(id.to(m_scheme), tile::KeyOrder::ZoomMajor); }
+
+void TileSet::insert(const tile::Id& id)
+{
+    const auto k = key(id);
+    // in order appends (e.g., from another sorted range) keep the vector sorted
+    if (m_n_sorted == m_keys.size() && (m_keys.empty() || m_keys.back() < k)) {
+        m_keys.push_back(k);
+        ++m_n_sorted;
+        return;
+    }
+    m_keys.push_back(k);
+}
+
+void TileSet::erase(const tile::Id& id)
+{
+    normalise();
+    const auto k = key(id);
+    const auto iter = std::lower_bound(m_keys.begin(), m_keys.end(), k);
+    if (iter != m_keys.end() && *iter == k) {
+        m_keys.erase(iter);
+        --m_n_sorted;
+    }
+}
+
+void TileSet::clear()
+{
+    m_keys.clear();
+    m_n_sorted = 0;
+}
+
+void TileSet::reserve(size_t n) { m_keys.reserve(n); }
+
+void TileSet::normalise() const
+{
+    if (m_n_sorted == m_keys.size())
+        return;
+    const auto middle = m_keys.begin() + std::ptrdiff_t(m_n_sorted);
+    radix_sort(std::span(m_keys).subspan(m_n_sorted));
+    std::inplace_merge(m_keys.begin(), middle, m_keys.end());
+    m_keys.erase(std::unique(m_keys.begin(), m_keys.end()), m_keys.end());
+    m_n_sorted = m_keys.size();
+}
+
+bool TileSet::contains(const tile::Id& id) const
+{
+    normalise();
+    return std::binary_search(m_keys.begin(), m_keys.end(), key(id));
+}
+
+size_t TileSet::size() const
+{
+    normalise();
+    return m_keys.size();
+}
+
+bool TileSet::empty() const { return m_keys.empty(); }
+
+std::span<const uint64_t> TileSet::keys() const
+{
+    normalise();
+    return m_keys;
+}
+
+TileSet::const_iterator TileSet::begin() const
+{
+    normalise();
+    return { m_keys.data(), m_scheme };
+}
+
+TileSet::const_iterator TileSet::end() const
+{
+    normalise();
+    return { m_keys.data() + m_keys.size(), m_scheme };
+}
+
+bool TileSet::operator==(const TileSet& other) const
+{
+    assert(m_scheme == other.m_scheme);
+    normalise();
+    other.normalise();
+    return m_keys == other.m_keys;
+}
+
+TileSet set_union(const TileSet& a, const TileSet& b)
+{
+    assert(a.m_scheme == b.m_scheme);
+    a.normalise();
+    b.normalise();
+    TileSet result(a.m_scheme);
+    result.m_keys.reserve(a.m_keys.size() + b.m_keys.size());
+    std::set_union(a.m_keys.begin(), a.m_keys.end(), b.m_keys.begin(), b.m_keys.end(), std::back_inserter(result.m_keys));
+    result.m_n_sorted = result.m_keys.size();
+    return result;
+}
+
+TileSet set_difference(const TileSet& a, const TileSet& b)
+{
+    assert(a.m_scheme == b.m_scheme);
+    a.normalise();
+    b.normalise();
+    TileSet result(a.m_scheme);
+    result.m_keys.reserve(a.m_keys.size());
+    std::set_difference(a.m_keys.begin(), a.m_keys.end(), b.m_keys.begin(), b.m_keys.end(), std::back_inserter(result.m_keys));
+    result.m_n_sorted = result.m_keys.size();
+    return result;
+}
+
+TileSet set_intersection(const TileSet& a, const TileSet& b)
+{
+    assert(a.m_scheme == b.m_scheme);
+    a.normalise();
+    b.normalise();
+    TileSet result(a.m_scheme);
+    result.m_keys.reserve(std::min(a.m_keys.size(), b.m_keys.size()));
+    std::set_intersection(a.m_keys.begin(), a.m_keys.end(), b.m_keys.begin(), b.m_keys.end(), std::back_inserter(result.m_keys));
+    result.m_n_sorted = result.m_keys.size();
+    return result;
+}
+
+TileSet compact(const TileSet& set)
+{
+    // children of a parent are consecutive in quad tree order, so complete quads are the top 4 entries of the stack
+    std::vector<Node> stack;
+    for (const auto& node : uncovered_in_quad_tree_order(set)) {
+        stack.push_back(node);
+        while (stack.size() >= 4) {
+            const auto last = stack.back();
+            if (last.zoom_level == 0 || (last.code & 3) != 3)
+                break;
+            const auto first = stack.end() - 4;
+            const auto complete = std::all_of(first, stack.end(), [&](const Node& n) { return n.zoom_level == last.zoom_level && n.code >> 2 == last.code >> 2; });
+            if (!complete)
+                break;
+            stack.erase(first, stack.end());
+            stack.push_back({ last.zoom_level - 1, last.code >> 2 });
+        }
+    }
+    std::vector<tile::Id> ids;
+    ids.reserve(stack.size());
+    for (const auto& node : stack)
+        ids.push_back({ node.zoom_level, morton::decode(node.code), set.scheme() });
+    if (ids.empty())
+        return TileSet(set.scheme());
+    return TileSet(ids);
+}
+
+TileSet expand_to_zoom(const TileSet& set, unsigned zoom_level)
+{
+    assert(zoom_level <= tile::max_key_zoom_level);
+    std::vector<tile::Id> ids;
+    for (const auto& node : uncovered_in_quad_tree_order(set)) {
+        if (node.zoom_level >= zoom_level) {
+            const auto code = node.code >> (2 * (node.zoom_level - zoom_level));
+            // descendants of the same ancestor are consecutive
+            if (ids.empty() || morton::encode(ids.back().coords) != code)
+                ids.push_back({ zoom_level, morton::decode(code), set.scheme() });
+            continue;
+        }
+        // the descendants form a contiguous range of Morton codes
+        const auto shift = 2 * (zoom_level - node.zoom_level);
+        for (auto code = node.code << shift; code < (node.code + 1) << shift; ++code)
+            ids.push_back({ zoom_level, morton::decode(code), set.scheme() });
+    }
+    if (ids.empty())
+        return TileSet(set.scheme());
+    return TileSet(ids);
+}
+
+} // namespace radix
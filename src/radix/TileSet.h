@@ -0,0 +1,122 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
+
+#include "sort.h"
+#include "tile.h"
+
+namespace radix {
+
+// A set of tile ids, stored as a sorted vector of packed keys (tile::KeyOrder::ZoomMajor, i.e., iteration gives the
+// same order as sorting with Id::operator<). Set operations are linear merges.
+//
+// All ids are stored in the scheme of the set, ids in another scheme are converted on insert and lookup.
+// insert() appends to an unsorted tail, which is sorted and merged on the next read access (amortised bulk insertion,
+// compatible with unordered_inserter). Because of that, concurrent reads are only safe after normalise().
+class TileSet {
+public:
+    using value_type = tile::Id;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = tile::Id;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const tile::Id*;
+        using reference = tile::Id;
+
+        const_iterator() = default;
+        const_iterator(const uint64_t* key, tile::Scheme scheme)
+            : m_key(key)
+            , m_scheme(scheme)
+        {
+        }
+        [[nodiscard]] tile::Id operator*() const { return tile::from_key(*m_key, tile::KeyOrder::ZoomMajor, m_scheme); }
+        const_iterator& operator++()
+        {
+            ++m_key;
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            auto copy = *this;
+            ++m_key;
+            return copy;
+        }
+        bool operator==(const const_iterator& other) const { return m_key == other.m_key; }
+
+    private:
+        const uint64_t* m_key = nullptr;
+        tile::Scheme m_scheme = tile::Scheme::Tms;
+    };
+
+    explicit TileSet(tile::Scheme scheme = tile::Scheme::Tms);
+    /// bulk construction (radix sort), the scheme is taken from the first id.
+    explicit TileSet(std::span<const tile::Id> ids, unsigned n_threads = 1);
+    explicit TileSet(const tile::IdSet& ids, tile::Scheme scheme = tile::Scheme::Tms);
+
+    void insert(const tile::Id& id);
+    void erase(const tile::Id& id);
+    void clear();
+    void reserve(size_t n);
+    /// sorts and merges pending inserts.
+    void normalise() const;
+
+    [[nodiscard]] bool contains(const tile::Id& id) const;
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] tile::Scheme scheme() const { return m_scheme; }
+    /// the sorted, unique keys.
+    [[nodiscard]] std::span<const uint64_t> keys() const;
+    [[nodiscard]] const_iterator begin() const;
+    [[nodiscard]] const_iterator end() const;
+
+    bool operator==(const TileSet& other) const;
+
+    friend TileSet set_union(const TileSet& a, const TileSet& b);
+    friend TileSet set_difference(const TileSet& a, const TileSet& b);
+    friend TileSet set_intersection(const TileSet& a, const TileSet& b);
+
+private:
+    [[nodiscard]] uint64_t key(const tile::Id& id) const;
+
+    tile::Scheme m_scheme;
+    // [0, m_n_sorted) is sorted and unique, the rest are pending inserts
+    mutable std::vector<uint64_t> m_keys;
+    mutable size_t m_n_sorted = 0;
+};
+
+/// linear merges, both sets must have the same scheme.
+TileSet set_union(const TileSet& a, const TileSet& b);
+TileSet set_difference(const TileSet& a, const TileSet& b);
+TileSet set_intersection(const TileSet& a, const TileSet& b);
+
+/// the minimal set of tiles covering the same area: tiles covered by another tile of the set are removed, and complete
+/// sibling quads are replaced by their parent (recursively).
+TileSet compact(const TileSet& set);
+/// the same area on a single zoom level: coarser tiles are replaced by their descendants on zoom_level, finer tiles by
+/// their ancestor.
+TileSet expand_to_zoom(const TileSet& set, unsigned zoom_level);
+
+} // namespace radix
@@ -0,0 +1,266 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "geometry.h"
+#include "geometry_batch.h"
+#include "simd.h"
+
+// Float fast path for double precision tile bounds (tile::SrsAndHeightBounds).
+// Boxes are stored relative to a double precision origin (some point near the camera, it doesn't have to be updated
+// every frame) and rounded outward to float, so that the float boxes contain the double ones. The tests below take the
+// remaining rounding errors into account, the results are therefore conservative:
+//  - classify() never reports Outside or Inside wrongly (it may say Intersecting instead),
+//  - intersect() may report false positives, but no false negatives,
+//  - distance_sq_lower_bound() is never larger than the exact squared distance (refine rather than pop).
+// Float batches are twice as wide as double ones.
+
+namespace radix::geometry {
+
+namespace detail {
+    // unit roundoff and the usual gamma_n = n u / (1 - n u) from floating point error analysis
+    template <typename T>
+    constexpr double unit_roundoff = double(std::numeric_limits<T>::epsilon()) / 2;
+    template <typename T>
+    constexpr double gamma(int n) { return n * unit_roundoff<T> / (1 - n * unit_roundoff<T>); }
+
+    // a - b = difference + error exactly (Knuth's TwoSum)
+    inline double difference_with_error(double a, double b, double* error)
+    {
+        const auto difference = a - b;
+        const auto a_virtual = difference + b;
+        const auto b_virtual = a_virtual - difference;
+        *error = (a - a_virtual) + (b_virtual - b);
+        return difference;
+    }
+
+    // largest float <= value + error
+    inline float round_down(double value, double error)
+    {
+        auto f = float(value);
+        if (double(f) > value || (double(f) == value && error < 0))
+            f = std::nextafter(f, -std::numeric_limits<float>::infinity());
+        return f;
+    }
+
+    // smallest float >= value + error
+    inline float round_up(double value, double error)
+    {
+        auto f = float(value);
+        if (double(f) < value || (double(f) == value && error > 0))
+            f = std::nextafter(f, std::numeric_limits<float>::infinity());
+        return f;
+    }
+
+    inline float round_down(double value) { return round_down(value, 0); }
+    inline float round_up(double value) { return round_up(value, 0); }
+} // namespace detail
+
+/// smallest float box containing box - origin.
+inline Aabb<3, float> to_relative(const Aabb<3, double>& box, const glm::dvec3& origin)
+{
+    Aabb<3, float> relative;
+    for (glm::length_t d = 0; d < 3; ++d) {
+        double error = 0;
+        const auto min = detail::difference_with_error(box.min[d], origin[d], &error);
+        relative.min[d] = detail::round_down(min, error);
+        const auto max = detail::difference_with_error(box.max[d], origin[d], &error);
+        relative.max[d] = detail::round_up(max, error);
+    }
+    return relative;
+}
+
+/// float boxes relative to a double precision origin, see the comment at the top of the file.
+class RelativeAabbBatch {
+public:
+    RelativeAabbBatch() = default;
+    explicit RelativeAabbBatch(const glm::dvec3& origin)
+        : m_origin(origin)
+    {
+    }
+    RelativeAabbBatch(const glm::dvec3& origin, std::span<const Aabb<3, double>> boxes)
+        : m_origin(origin)
+    {
+        m_boxes.reserve(boxes.size());
+        for (const auto& box : boxes)
+            push_back(box);
+    }
+
+    void push_back(const Aabb<3, double>& box)
+    {
+        const auto relative = to_relative(box, m_origin);
+        for (glm::length_t d = 0; d < 3; ++d)
+            m_max_abs_coordinate = std::max({ m_max_abs_coordinate, std::abs(relative.min[d]), std::abs(relative.max[d]) });
+        m_boxes.push_back(relative);
+    }
+    void clear()
+    {
+        m_boxes.clear();
+        m_max_abs_coordinate = 0;
+    }
+
+    [[nodiscard]] const glm::dvec3& origin() const { return m_origin; }
+    [[nodiscard]] const AabbBatch<3, float>& boxes() const { return m_boxes; }
+    /// bound on the absolute value of all float coordinates, used for the error bounds of plane distances.
+    [[nodiscard]] float max_abs_coordinate() const { return m_max_abs_coordinate; }
+    [[nodiscard]] size_t size() const { return m_boxes.size(); }
+    [[nodiscard]] bool empty() const { return m_boxes.empty(); }
+
+private:
+    glm::dvec3 m_origin = {};
+    AabbBatch<3, float> m_boxes;
+    float m_max_abs_coordinate = 0;
+};
+
+/// a plane moved to the origin of a RelativeAabbBatch and converted to float. margin bounds the difference between the
+/// float distance (computed as in the batch kernels) and the exact double distance, for points with coordinates
+/// of at most max_abs_coordinate.
+struct RelativePlane {
+    Plane<float> plane;
+    float margin;
+    glm::bvec3 positive_normal; // from the double precision normal, selects the p- and n-vertex
+};
+
+inline RelativePlane to_relative(const Plane<double>& plane, const glm::dvec3& origin, float max_abs_coordinate)
+{
+    // distance(plane, p) = dot(n, p - origin) + dot(n, origin) + d
+    const auto n = plane.normal;
+    const auto distance = glm::dot(n, origin) + plane.distance;
+    const auto n_l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    const auto n_o_l1 = std::abs(n.x * origin.x) + std::abs(n.y * origin.y) + std::abs(n.z * origin.z);
+
+    // float evaluation of 3 products and 3 sums with rounded inputs (see Higham, Accuracy and Stability of Numerical
+    // Algorithms, chapter 3): gamma_5, we use gamma_6 to cover the rounding of the margin computation itself.
+    // the second term covers the double precision computation of distance.
+    const auto margin = detail::gamma<float>(6) * (n_l1 * double(max_abs_coordinate) + std::abs(distance))
+        + detail::gamma<double>(4) * (n_o_l1 + std::abs(plane.distance));
+    return { Plane<float> { glm::vec3(n), float(distance) }, detail::round_up(margin), glm::bvec3(n.x >= 0, n.y >= 0, n.z >= 0) };
+}
+
+namespace detail {
+    template <typename Batch>
+    void classify_relative_range(const AabbBatch<3, float>& boxes, std::span<const RelativePlane> planes, size_t begin, size_t end, Classification* out)
+    {
+        constexpr auto width = Batch::width;
+        for (size_t i = begin; i + width <= end; i += width) {
+            auto outside = Batch::Mask::none();
+            auto intersecting = Batch::Mask::none();
+            for (const auto& relative : planes) {
+                const auto& plane = relative.plane;
+                const auto& px = relative.positive_normal.x ? boxes.max[0] : boxes.min[0];
+                const auto& py = relative.positive_normal.y ? boxes.max[1] : boxes.min[1];
+                const auto& pz = relative.positive_normal.z ? boxes.max[2] : boxes.min[2];
+                const auto& nx = relative.positive_normal.x ? boxes.min[0] : boxes.max[0];
+                const auto& ny = relative.positive_normal.y ? boxes.min[1] : boxes.max[1];
+                const auto& nz = relative.positive_normal.z ? boxes.min[2] : boxes.max[2];
+                const auto a = Batch::broadcast(plane.normal.x);
+                const auto b = Batch::broadcast(plane.normal.y);
+                const auto c = Batch::broadcast(plane.normal.z);
+                const auto d = Batch::broadcast(plane.distance);
+                const auto margin = Batch::broadcast(relative.margin);
+                const auto negative_margin = Batch::broadcast(-relative.margin);
+
+                const auto p_distance = a * Batch::load(&px[i]) + b * Batch::load(&py[i]) + c * Batch::load(&pz[i]) + d;
+                const auto n_distance = a * Batch::load(&nx[i]) + b * Batch::load(&ny[i]) + c * Batch::load(&nz[i]) + d;
+                outside = outside | (p_distance < negative_margin);
+                intersecting = intersecting | (n_distance < margin);
+            }
+            const auto outside_bits = bits(outside);
+            const auto intersecting_bits = bits(intersecting);
+            for (size_t l = 0; l < width; ++l) {
+                if (outside_bits & (1u << l))
+                    out[i + l] = Classification::Outside;
+                else if (intersecting_bits & (1u << l))
+                    out[i + l] = Classification::Intersecting;
+                else
+                    out[i + l] = Classification::Inside;
+            }
+        }
+    }
+
+    template <typename Batch>
+    void distance_sq_lower_bound_range(const AabbBatch<3, float>& boxes, const glm::vec3& point_lower, const glm::vec3& point_upper, size_t begin, size_t end, float* out)
+    {
+        // fl(x) * (1 - 2u) <= x for x >= 0, and the sum of 3 rounded squares is shrunk by (1 - 6u).
+        constexpr auto u = float(unit_roundoff<float>);
+        const auto zero = Batch::broadcast(0);
+        const auto gap_shrink = Batch::broadcast(1 - 2 * u);
+        const auto sum_shrink = Batch::broadcast(1 - 6 * u);
+        for (size_t i = begin; i + Batch::width <= end; i += Batch::width) {
+            auto distance_squared = zero;
+            for (glm::length_t d = 0; d < 3; ++d) {
+                const auto below = Batch::load(&boxes.min[d][i]) - Batch::broadcast(point_upper[d]);
+                const auto above = Batch::broadcast(point_lower[d]) - Batch::load(&boxes.max[d][i]);
+                const auto gap = max(max(below, above), zero) * gap_shrink;
+                distance_squared = distance_squared + gap * gap;
+            }
+            (distance_squared * sum_shrink).store(out + i);
+        }
+    }
+} // namespace detail
+
+/// conservative frustum classification of the float boxes against double precision planes.
+template <typename PlaneContainer>
+void classify(const RelativeAabbBatch& boxes, const PlaneContainer& planes, std::span<Classification> out)
+{
+    assert(out.size() == boxes.size());
+    std::vector<RelativePlane> relative_planes;
+    for (const auto& plane : planes)
+        relative_planes.push_back(to_relative(plane, boxes.origin(), boxes.max_abs_coordinate()));
+
+    using Batch = simd::Batch<float>;
+    const auto n_simd = boxes.size() - boxes.size() % Batch::width;
+    detail::classify_relative_range<Batch>(boxes.boxes(), relative_planes, 0, n_simd, out.data());
+    detail::classify_relative_range<simd::Scalar<float>>(boxes.boxes(), relative_planes, n_simd, boxes.size(), out.data());
+}
+
+/// conservative intersection test against a double precision box (false positives are possible).
+inline void intersect(const RelativeAabbBatch& boxes, const Aabb<3, double>& box, std::span<bool> out)
+{
+    intersect(boxes.boxes(), to_relative(box, boxes.origin()), out);
+}
+
+/// lower bound of distance_sq(box, point) for every box.
+inline void distance_sq_lower_bound(const RelativeAabbBatch& boxes, const glm::dvec3& point, std::span<float> out)
+{
+    assert(out.size() == boxes.size());
+    glm::vec3 point_lower;
+    glm::vec3 point_upper;
+    for (glm::length_t d = 0; d < 3; ++d) {
+        double error = 0;
+        const auto relative = detail::difference_with_error(point[d], boxes.origin()[d], &error);
+        point_lower[d] = detail::round_down(relative, error);
+        point_upper[d] = detail::round_up(relative, error);
+    }
+    using Batch = simd::Batch<float>;
+    const auto n_simd = boxes.size() - boxes.size() % Batch::width;
+    detail::distance_sq_lower_bound_range<Batch>(boxes.boxes(), point_lower, point_upper, 0, n_simd, out.data());
+    detail::distance_sq_lower_bound_range<simd::Scalar<float>>(boxes.boxes(), point_lower, point_upper, n_simd, boxes.size(), out.data());
+}
+
+} // namespace radix::geometry
@@ -0,0 +1,74 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <vector>
+
+#include "geometry.h"
+#include "quad_tree.h"
+
+namespace radix::quad_tree {
+
+// onTheFlyTraverse with hierarchical frustum culling. Returns only the leaves that are not outside the planes.
+//
+// bounds(node) must return a geometry::Aabb<3, T>, and the bounds of children must be contained in the bounds of their parent.
+// An active plane mask is passed down the recursion: planes that a node is completely inside of are not tested for its
+// descendants, and subtrees that are completely inside are not tested at all (bounds is not even called).
+// Nodes outside are not refined. predicate and generate_children are used as in onTheFlyTraverse (generate_children
+// must return 4 children).
+template <typename DataType, typename PlaneContainer, typename BoundsFunction, typename PredicateFunction, typename RefineFunction>
+std::vector<DataType> onTheFlyTraverseFrustumCulled(const DataType& root, const PlaneContainer& planes, const BoundsFunction& bounds, const PredicateFunction& predicate, const RefineFunction& generate_children)
+{
+    struct CullingNode {
+        DataType data = {};
+        unsigned plane_mask = 0;
+        bool outside = false;
+    };
+    const auto make_node = [&](const DataType& data, unsigned parent_mask) {
+        if (parent_mask == 0)
+            return CullingNode { data, 0, false };
+        const auto [classification, mask] = geometry::classify(bounds(data), planes, parent_mask);
+        return CullingNode { data, mask, classification == geometry::Classification::Outside };
+    };
+
+    const auto n_planes = unsigned(std::distance(std::begin(planes), std::end(planes)));
+    assert(n_planes < 32);
+    const auto culled_leaves = onTheFlyTraverse(
+        make_node(root, (1u << n_planes) - 1),
+        [&](const CullingNode& node) { return !node.outside && predicate(node.data); },
+        [&](const CullingNode& node) {
+            const auto children = generate_children(node.data);
+            std::array<CullingNode, 4> culling_children;
+            std::transform(children.begin(), children.end(), culling_children.begin(), [&](const DataType& child) { return make_node(child, node.plane_mask); });
+            return culling_children;
+        });
+
+    std::vector<DataType> leaves;
+    leaves.reserve(culled_leaves.size());
+    for (const auto& node : culled_leaves) {
+        if (!node.outside)
+            leaves.push_back(node.data);
+    }
+    return leaves;
+}
+
+} // namespace radix::quad_tree
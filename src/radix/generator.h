@@ -0,0 +1,133 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace radix {
+
+// A minimal, single pass coroutine generator (std::generator is C++23 and not available on all our platforms yet).
+// Values are produced lazily, i.e., the coroutine body runs only as far as the consumer iterates.
+// Destroying the generator (or breaking out of a range-for loop) stops the coroutine.
+template <typename T>
+class generator {
+public:
+    struct promise_type {
+        const T* m_value = nullptr;
+        std::exception_ptr m_exception;
+
+        generator get_return_object() { return generator { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        // the yielded value (even a temporary) lives until the coroutine is resumed, so a pointer is enough.
+        std::suspend_always yield_value(const T& value) noexcept
+        {
+            m_value = std::addressof(value);
+            return {};
+        }
+        void return_void() { }
+        void unhandled_exception() { m_exception = std::current_exception(); }
+
+        // disallow co_await inside generators
+        template <typename U>
+        std::suspend_never await_transform(U&&) = delete;
+    };
+
+    class iterator {
+        std::coroutine_handle<promise_type> m_handle = nullptr;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        iterator() = default;
+        explicit iterator(std::coroutine_handle<promise_type> handle)
+            : m_handle(handle)
+        {
+        }
+        reference operator*() const { return *m_handle.promise().m_value; }
+        pointer operator->() const { return m_handle.promise().m_value; }
+        iterator& operator++()
+        {
+            m_handle.resume();
+            if (m_handle.done())
+                rethrow_if_exception(m_handle);
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+        bool operator==(std::default_sentinel_t) const { return !m_handle || m_handle.done(); }
+    };
+
+    generator() = default;
+    generator(const generator&) = delete;
+    generator& operator=(const generator&) = delete;
+    generator(generator&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, nullptr))
+    {
+    }
+    generator& operator=(generator&& other) noexcept
+    {
+        if (this != &other) {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    ~generator()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    /// begin() starts the coroutine. it must be called only once.
+    iterator begin()
+    {
+        if (!m_handle)
+            return {};
+        m_handle.resume();
+        if (m_handle.done())
+            rethrow_if_exception(m_handle);
+        return iterator { m_handle };
+    }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    explicit generator(std::coroutine_handle<promise_type> handle)
+        : m_handle(handle)
+    {
+    }
+    static void rethrow_if_exception(std::coroutine_handle<promise_type> handle)
+    {
+        if (handle.promise().m_exception)
+            std::rethrow_exception(handle.promise().m_exception);
+    }
+
+    std::coroutine_handle<promise_type> m_handle = nullptr;
+};
+
+} // namespace radix
@@ -21,13 +21,22 @@
 
 #include <algorithm>
 #include <array>
+#include <cassert>
+#include <cstddef>
 #include <iterator>
+#include <limits>
 #include <optional>
 #include <vector>
 #include <span>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
 
 #include <glm/glm.hpp>
 
+#include "simd.h"
+
 namespace radix::geometry {
 
 template <typename T = double>
@@ -179,6 +188,16 @@ struct Plane {
 template <typename T>
 Plane(glm::vec<3, T>, T) -> Plane<T>;
 
+/// planes point inwards, i.e., distance(plane, point) > 0 for points inside
+template <typename T>
+using Frustum = std::array<Plane<T>, 6>;
+
+enum class Classification : unsigned char {
+    Outside = 0,
+    Intersecting = 1,
+    Inside = 2
+};
+
 // functions
 template <glm::length_t n_dimensions, typename T>
 bool inside(const glm::vec<n_dimensions, T>& point, const Aabb<n_dimensions, T>& box)
@@ -234,6 +253,68 @@ T distance(const Plane<T>& plane, const glm::tvec3<T>& point)
     return glm::dot(plane.normal, point) + plane.distance;
 }
 
+/// returns the corner of the box, that is furthest in the direction of the normal (the "p-vertex")
+template <typename T>
+glm::tvec3<T> positive_vertex(const Aabb<3, T>& box, const glm::tvec3<T>& normal)
+{
+    return { normal.x >= 0 ? box.max.x : box.min.x, normal.y >= 0 ? box.max.y : box.min.y, normal.z >= 0 ? box.max.z : box.min.z };
+}
+
+/// returns the corner of the box, that is furthest against the direction of the normal (the "n-vertex")
+template <typename T>
+glm::tvec3<T> negative_vertex(const Aabb<3, T>& box, const glm::tvec3<T>& normal)
+{
+    return { normal.x >= 0 ? box.min.x : box.max.x, normal.y >= 0 ? box.min.y : box.max.y, normal.z >= 0 ? box.min.z : box.max.z };
+}
+
+/// outside: the box is completely on the negative side of the plane (touching is not outside).
+/// inside: the box is completely on the non-negative side.
+template <typename T>
+Classification classify(const Aabb<3, T>& box, const Plane<T>& plane)
+{
+    if (distance(plane, positive_vertex(box, plane.normal)) < 0)
+        return Classification::Outside;
+    if (distance(plane, negative_vertex(box, plane.normal)) < 0)
+        return Classification::Intersecting;
+    return Classification::Inside;
+}
+
+/// classifies against the intersection of the half spaces (e.g., a Frustum<T>). this is conservative: boxes close to
+/// the corners of the frustum can be reported as intersecting, even if they are outside.
+template <typename T, typename PlaneContainer>
+Classification classify(const Aabb<3, T>& box, const PlaneContainer& planes)
+{
+    auto result = Classification::Inside;
+    for (const auto& plane : planes) {
+        const auto c = classify(box, plane);
+        if (c == Classification::Outside)
+            return c;
+        if (c == Classification::Intersecting)
+            result = c;
+    }
+    return result;
+}
+
+/// same as above, but only planes with their bit set in plane_mask are tested (bit i corresponds to the i-th plane).
+/// the returned mask has the bits of planes cleared, that the box is completely inside of. those don't need to be tested
+/// for boxes contained in this one (e.g., children in a tree). an empty mask means inside.
+template <typename T, typename PlaneContainer>
+std::pair<Classification, unsigned> classify(const Aabb<3, T>& box, const PlaneContainer& planes, unsigned plane_mask)
+{
+    unsigned plane_bit = 1;
+    for (const auto& plane : planes) {
+        if (plane_mask & plane_bit) {
+            const auto c = classify(box, plane);
+            if (c == Classification::Outside)
+                return { c, plane_mask };
+            if (c == Classification::Inside)
+                plane_mask &= ~plane_bit;
+        }
+        plane_bit <<= 1;
+    }
+    return { plane_mask ? Classification::Intersecting : Classification::Inside, plane_mask };
+}
+
 template <typename T>
 std::optional<glm::tvec3<T>> intersection(const Line<3, T>& line, const Plane<T>& plane)
 {
@@ -253,6 +334,32 @@ glm::tvec3<T> intersection(const Edge<3, T>& line, const Plane<T>& plane)
 }
 
 
+/// slab test. the line is treated as a ray (t >= 0), returns the parameter interval [t_entry, t_exit] inside the box.
+/// the direction doesn't need to be normalised, components can be 0.
+template <typename T>
+std::optional<std::pair<T, T>> ray_intersection(const Line<3, T>& ray, const Aabb<3, T>& box)
+{
+    T t_entry = 0;
+    T t_exit = std::numeric_limits<T>::max();
+    for (int d = 0; d < 3; ++d) {
+        if (ray.direction[d] == 0) {
+            if (ray.point[d] < box.min[d] || ray.point[d] > box.max[d])
+                return {};
+            continue;
+        }
+        const auto inverse = T(1) / ray.direction[d];
+        auto t0 = (box.min[d] - ray.point[d]) * inverse;
+        auto t1 = (box.max[d] - ray.point[d]) * inverse;
+        if (t0 > t1)
+            std::swap(t0, t1);
+        t_entry = std::max(t_entry, t0);
+        t_exit = std::min(t_exit, t1);
+        if (t_entry > t_exit)
+            return {};
+    }
+    return std::make_pair(t_entry, t_exit);
+}
+
 template <typename T>
 std::optional<Line<3, T>> intersection(const Plane<T>& p1, const Plane<T>& p2)
 {
@@ -329,6 +436,112 @@ std::vector<Triangle<3, T>> clip(std::vector<Triangle<3, T>> triangles, const Pl
     return triangles;
 }
 
+/// convex polygon with a fixed maximum number of vertices. it lives on the stack, i.e., it doesn't allocate.
+template <glm::length_t n_dimensions, typename T, size_t capacity>
+struct Polygon {
+    std::array<glm::vec<n_dimensions, T>, capacity> vertices = {};
+    size_t size = 0;
+
+    Polygon() = default;
+    Polygon(const Triangle<n_dimensions, T>& triangle)
+        : size(3)
+    {
+        static_assert(capacity >= 3);
+        std::copy(triangle.begin(), triangle.end(), vertices.begin());
+    }
+
+    void push_back(const glm::vec<n_dimensions, T>& vertex)
+    {
+        assert(size < capacity);
+        vertices[size++] = vertex;
+    }
+    [[nodiscard]] bool empty() const { return size == 0; }
+    auto begin() const { return vertices.begin(); }
+    auto end() const { return vertices.begin() + std::ptrdiff_t(size); }
+    const glm::vec<n_dimensions, T>& operator[](size_t i) const { return vertices[i]; }
+};
+
+/// Sutherland-Hodgman clipping of a convex polygon, keeping the part with distance(plane, point) > 0 (same as the
+/// triangle clipping above). Clipping against one plane adds at most one vertex, which must fit into the capacity.
+template <typename T, size_t capacity>
+Polygon<3, T, capacity> clip(const Polygon<3, T, capacity>& polygon, const Plane<T>& plane)
+{
+    Polygon<3, T, capacity> clipped;
+    if (polygon.empty())
+        return clipped;
+    std::array<T, capacity> distances;
+    for (size_t i = 0; i < polygon.size; ++i)
+        distances[i] = distance(plane, polygon[i]);
+
+    size_t previous = polygon.size - 1;
+    for (size_t current = 0; current < polygon.size; ++current) {
+        const auto current_inside = distances[current] > 0;
+        const auto previous_inside = distances[previous] > 0;
+        // always intersect from the inside to the outside vertex, so that shared edges produce identical points.
+        if (current_inside && !previous_inside)
+            clipped.push_back(intersection(Edge<3, T> { polygon[current], polygon[previous] }, plane));
+        if (!current_inside && previous_inside)
+            clipped.push_back(intersection(Edge<3, T> { polygon[previous], polygon[current] }, plane));
+        if (current_inside)
+            clipped.push_back(polygon[current]);
+        previous = current;
+    }
+    return clipped;
+}
+
+/// clips against several planes (e.g., a Frustum<T>). the capacity must be at least 3 + number of planes for triangles.
+template <typename T, size_t capacity, typename PlaneContainer>
+Polygon<3, T, capacity> clip(Polygon<3, T, capacity> polygon, const PlaneContainer& planes)
+{
+    for (const auto& plane : planes) {
+        if (polygon.empty())
+            break;
+        polygon = clip(polygon, plane);
+    }
+    return polygon;
+}
+
+/// fan triangulation of a convex polygon into a caller provided output iterator (e.g., a back_inserter into a reused vector)
+template <glm::length_t n_dimensions, typename T, size_t capacity, typename OutputIterator>
+OutputIterator triangulise(const Polygon<n_dimensions, T, capacity>& polygon, OutputIterator out)
+{
+    for (size_t i = 2; i < polygon.size; ++i)
+        *out++ = Triangle<n_dimensions, T> { polygon[0], polygon[i - 1], polygon[i] };
+    return out;
+}
+
+namespace detail {
+    // number of planes of fixed size containers (std::array, Frustum), 0 for dynamically sized ones
+    template <typename PlaneContainer>
+    constexpr size_t static_plane_count()
+    {
+        if constexpr (requires { std::tuple_size<PlaneContainer>::value; })
+            return std::tuple_size_v<PlaneContainer>;
+        else
+            return 0;
+    }
+} // namespace detail
+
+/// allocation free alternative to clip(std::vector<Triangle>, planes): the triangles are clipped as polygons on the stack and
+/// written to the output iterator. a triangle gains at most one vertex per plane, for fixed size containers (std::array,
+/// Frustum) the polygon capacity is derived from the number of planes. other containers (std::vector, std::span) need
+/// an explicit capacity, e.g., clip<3 + max_planes>(...), and throw std::length_error if there are more planes.
+template <size_t capacity = 0, typename T, typename PlaneContainer, typename OutputIterator>
+OutputIterator clip(std::span<const Triangle<3, T>> triangles, const PlaneContainer& planes, OutputIterator out)
+{
+    constexpr auto n_static_planes = detail::static_plane_count<PlaneContainer>();
+    static_assert(capacity > 0 || n_static_planes > 0, "the polygon capacity must be given for dynamically sized plane containers");
+    constexpr auto polygon_capacity = capacity > 0 ? capacity : 3 + n_static_planes;
+    static_assert(polygon_capacity >= 3 + n_static_planes, "the polygon capacity is too small for the number of planes");
+    if constexpr (n_static_planes == 0) {
+        if (3 + size_t(std::size(planes)) > polygon_capacity)
+            throw std::length_error("radix::geometry::clip: more planes than the polygon capacity allows");
+    }
+    for (const auto& triangle : triangles)
+        out = triangulise(clip(Polygon<3, T, polygon_capacity>(triangle), planes), out);
+    return out;
+}
+
 template <typename T>
 std::vector<Triangle<3, T>> triangulise(const Aabb<3, T>& box)
 {
@@ -438,12 +651,188 @@ std::array<std::array<glm::vec<3, T>, 4>, 6> quads(const radix::geometry::Aabb<3
         Face{a, e, h, d}};
 }
 
+namespace detail {
+    /// Sutherland-Hodgman in homogeneous clip space, keeps dot(plane, vertex) >= 0.
+    template <typename T, size_t capacity>
+    Polygon<4, T, capacity> clip_homogeneous(const Polygon<4, T, capacity>& polygon, const glm::tvec4<T>& plane)
+    {
+        Polygon<4, T, capacity> clipped;
+        if (polygon.empty())
+            return clipped;
+        std::array<T, capacity> distances;
+        for (size_t i = 0; i < polygon.size; ++i)
+            distances[i] = glm::dot(plane, polygon[i]);
+
+        const auto intersect = [&](size_t inside, size_t outside) {
+            const auto t = distances[inside] / (distances[inside] - distances[outside]);
+            return polygon[inside] + (polygon[outside] - polygon[inside]) * t;
+        };
+        size_t previous = polygon.size - 1;
+        for (size_t current = 0; current < polygon.size; ++current) {
+            const auto current_inside = distances[current] >= 0;
+            const auto previous_inside = distances[previous] >= 0;
+            if (current_inside != previous_inside)
+                clipped.push_back(current_inside ? intersect(current, previous) : intersect(previous, current));
+            if (current_inside)
+                clipped.push_back(polygon[current]);
+            previous = current;
+        }
+        return clipped;
+    }
+
+    /// signed area after perspective division (shoelace formula). ccw in normalised device coordinates is positive.
+    template <typename T, size_t capacity>
+    T signed_ndc_area(const Polygon<4, T, capacity>& polygon)
+    {
+        T area = 0;
+        size_t previous = polygon.size - 1;
+        for (size_t current = 0; current < polygon.size; ++current) {
+            const auto& a = polygon[previous];
+            const auto& b = polygon[current];
+            area += (a.x / a.w) * (b.y / b.w) - (b.x / b.w) * (a.y / a.w);
+            previous = current;
+        }
+        return area / 2;
+    }
+} // namespace detail
+
+/// area of the box's silhouette on screen, in normalised device coordinates (the whole viewport has an area of 4,
+/// multiply by width * height / 4 to get pixels). Expects an OpenGL style view projection matrix (z in [-w, w]).
+/// The box is clipped by the near plane and the viewport, but not by the far plane. Unlike triangulising, clipping and
+/// projecting the triangles, this works on the 6 faces directly and doesn't allocate.
+template <typename T>
+T projected_area(const Aabb<3, T>& box, const glm::tmat4x4<T>& view_projection)
+{
+    using Face = Polygon<4, T, 9>; // a quad gains at most one vertex per clipping plane
+    std::array<glm::tvec4<T>, 8> clip_space;
+    const auto box_corners = corners(box);
+    for (size_t i = 0; i < 8; ++i)
+        clip_space[i] = view_projection * glm::tvec4<T>(box_corners[i], 1);
+
+    // near, left, right, bottom, top
+    constexpr auto planes = std::array {
+        glm::tvec4<T>(0, 0, 1, 1), glm::tvec4<T>(1, 0, 0, 1), glm::tvec4<T>(-1, 0, 0, 1), glm::tvec4<T>(0, 1, 0, 1), glm::tvec4<T>(0, -1, 0, 1)
+    };
+    // indices into corners(), counter clockwise when looking from the outside (same winding as triangulise).
+    constexpr std::array<std::array<unsigned, 4>, 6> faces = { {
+        { 0, 1, 2, 3 }, { 4, 7, 6, 5 }, { 0, 4, 5, 1 }, { 1, 5, 6, 2 }, { 2, 6, 7, 3 }, { 3, 7, 4, 0 },
+    } };
+
+    // front facing faces project to one sign, back facing ones to the other. the back facing faces cover the silhouette
+    // exactly once, also after near plane clipping (the missing cap would be front facing).
+    T positive = 0;
+    T negative = 0;
+    for (const auto& face : faces) {
+        Face polygon;
+        for (const auto i : face)
+            polygon.push_back(clip_space[i]);
+        for (const auto& plane : planes)
+            polygon = detail::clip_homogeneous(polygon, plane);
+        if (polygon.size < 3)
+            continue;
+        const auto area = detail::signed_ndc_area(polygon);
+        if (area > 0)
+            positive += area;
+        else
+            negative -= area;
+    }
+    return std::max(positive, negative);
+}
+
+/// cheap conservative bound of projected_area(): the screen space bounding rectangle of the projected corners,
+/// clipped to the viewport. Boxes reaching behind the near plane get the area of the whole viewport (4).
+template <typename T>
+T projected_area_bound(const Aabb<3, T>& box, const glm::tmat4x4<T>& view_projection)
+{
+    auto min = glm::tvec2<T>(std::numeric_limits<T>::max());
+    auto max = glm::tvec2<T>(std::numeric_limits<T>::lowest());
+    for (const auto& corner : corners(box)) {
+        const auto clip_space = view_projection * glm::tvec4<T>(corner, 1);
+        if (clip_space.z + clip_space.w < 0)
+            return 4;
+        const auto ndc = glm::tvec2<T>(clip_space.x / clip_space.w, clip_space.y / clip_space.w);
+        min = glm::min(min, ndc);
+        max = glm::max(max, ndc);
+    }
+    min = glm::max(min, glm::tvec2<T>(-1));
+    max = glm::min(max, glm::tvec2<T>(1));
+    return std::max(max.x - min.x, T(0)) * std::max(max.y - min.y, T(0));
+}
+
+namespace detail {
+    /// min / max over the points' components, reading them as a flat array of T. One iteration loads n_dims batches,
+    /// i.e., Batch::width points. Lane l of the j-th batch always holds the component (j * width + l) % n_dims.
+    /// Returns the number of processed points, the rest has to be done by the caller.
+    template <typename Batch, glm::length_t n_dims, typename T>
+    size_t expand_by_interleaved(std::span<const glm::vec<n_dims, T>> points, Aabb<n_dims, T>* bounds)
+    {
+        constexpr auto width = Batch::width;
+        const auto n_simd = points.size() - points.size() % width;
+        if (n_simd == 0)
+            return 0;
+        const T* data = &points.front().x;
+        std::array<Batch, n_dims> lower;
+        std::array<Batch, n_dims> upper;
+        lower.fill(Batch::broadcast(std::numeric_limits<T>::max()));
+        upper.fill(Batch::broadcast(std::numeric_limits<T>::lowest()));
+        for (size_t i = 0; i < n_simd * n_dims; i += width * n_dims) {
+            for (glm::length_t j = 0; j < n_dims; ++j) {
+                const auto values = Batch::load(data + i + j * width);
+                // argument order matters for NaNs: same semantics as glm::min(bounds.min, point), NaNs are skipped
+                lower[j] = min(values, lower[j]);
+                upper[j] = max(values, upper[j]);
+            }
+        }
+        std::array<T, width> lower_lanes;
+        std::array<T, width> upper_lanes;
+        for (glm::length_t j = 0; j < n_dims; ++j) {
+            lower[j].store(lower_lanes.data());
+            upper[j].store(upper_lanes.data());
+            for (size_t l = 0; l < width; ++l) {
+                const auto component = (j * width + l) % n_dims;
+                bounds->min[component] = glm::min(bounds->min[component], lower_lanes[l]);
+                bounds->max[component] = glm::max(bounds->max[component], upper_lanes[l]);
+            }
+        }
+        return n_simd;
+    }
+} // namespace detail
+
+/// bounding box of the points, the result for an empty span is a default constructed (invalid) Aabb.
+/// float and double points are processed with simd, results are identical to calling expand_by for every point.
 template <glm::length_t n_dims, typename T>
 radix::geometry::Aabb<n_dims, T> find_bounds(const std::span<const glm::vec<n_dims, T>> points) {
     radix::geometry::Aabb<n_dims, T> bounds;
-    for (const auto &point : points) {
+    size_t n_processed = 0;
+    if constexpr (std::is_floating_point_v<T> && sizeof(glm::vec<n_dims, T>) == n_dims * sizeof(T))
+        n_processed = detail::expand_by_interleaved<simd::Batch<T>>(points, &bounds);
+    for (const auto& point : points.subspan(n_processed)) {
         bounds.expand_by(point);
     }
     return bounds;
 }
+
+/// multi threaded version of the above, for millions of points. The span is split into n_threads parts,
+/// the calling thread works on the first one.
+template <glm::length_t n_dims, typename T>
+radix::geometry::Aabb<n_dims, T> find_bounds(const std::span<const glm::vec<n_dims, T>> points, unsigned n_threads)
+{
+    n_threads = std::max(1u, std::min<unsigned>(n_threads, unsigned(points.size() / 4096 + 1)));
+    std::vector<Aabb<n_dims, T>> partial_bounds(n_threads);
+    std::vector<std::thread> threads;
+    threads.reserve(n_threads - 1);
+    const auto part_size = points.size() / n_threads;
+    for (unsigned i = 1; i < n_threads; ++i) {
+        const auto part = points.subspan(i * part_size, i + 1 == n_threads ? std::dynamic_extent : part_size);
+        threads.emplace_back([part, &bounds = partial_bounds[i]]() { bounds = find_bounds(part); });
+    }
+    partial_bounds[0] = find_bounds(points.first(part_size));
+    for (auto& thread : threads)
+        thread.join();
+
+    Aabb<n_dims, T> bounds;
+    for (const auto& b : partial_bounds)
+        bounds.expand_by(b);
+    return bounds;
+}
 } // namespace radix::geometry
@@ -0,0 +1,310 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "geometry.h"
+#include "simd.h"
+
+namespace radix::geometry {
+
+/// structure of arrays storage for many boxes, so that they can be processed with simd.
+template <glm::length_t n_dims, typename T>
+class AabbBatch {
+public:
+    std::array<std::vector<T>, n_dims> min;
+    std::array<std::vector<T>, n_dims> max;
+
+    AabbBatch() = default;
+    explicit AabbBatch(std::span<const Aabb<n_dims, T>> boxes)
+    {
+        reserve(boxes.size());
+        for (const auto& box : boxes)
+            push_back(box);
+    }
+
+    [[nodiscard]] size_t size() const { return min[0].size(); }
+    [[nodiscard]] bool empty() const { return min[0].empty(); }
+    void reserve(size_t n)
+    {
+        for (glm::length_t d = 0; d < n_dims; ++d) {
+            min[d].reserve(n);
+            max[d].reserve(n);
+        }
+    }
+    void clear()
+    {
+        for (glm::length_t d = 0; d < n_dims; ++d) {
+            min[d].clear();
+            max[d].clear();
+        }
+    }
+    void push_back(const Aabb<n_dims, T>& box)
+    {
+        for (glm::length_t d = 0; d < n_dims; ++d) {
+            min[d].push_back(box.min[d]);
+            max[d].push_back(box.max[d]);
+        }
+    }
+    [[nodiscard]] Aabb<n_dims, T> operator[](size_t i) const
+    {
+        Aabb<n_dims, T> box;
+        for (glm::length_t d = 0; d < n_dims; ++d) {
+            box.min[d] = min[d][i];
+            box.max[d] = max[d][i];
+        }
+        return box;
+    }
+};
+
+namespace detail {
+    template <typename Batch, typename T, typename PlaneContainer>
+    void classify_range(const AabbBatch<3, T>& boxes, const PlaneContainer& planes, size_t begin, size_t end, Classification* out)
+    {
+        constexpr auto width = Batch::width;
+        for (size_t i = begin; i + width <= end; i += width) {
+            auto outside = Batch::Mask::none();
+            auto intersecting = Batch::Mask::none();
+            for (const auto& plane : planes) {
+                // p-/n-vertex selection depends only on the plane, so it's a choice between the min and max arrays.
+                const auto& px = plane.normal.x >= 0 ? boxes.max[0] : boxes.min[0];
+                const auto& py = plane.normal.y >= 0 ? boxes.max[1] : boxes.min[1];
+                const auto& pz = plane.normal.z >= 0 ? boxes.max[2] : boxes.min[2];
+                const auto& nx = plane.normal.x >= 0 ? boxes.min[0] : boxes.max[0];
+                const auto& ny = plane.normal.y >= 0 ? boxes.min[1] : boxes.max[1];
+                const auto& nz = plane.normal.z >= 0 ? boxes.min[2] : boxes.max[2];
+                const auto a = Batch::broadcast(plane.normal.x);
+                const auto b = Batch::broadcast(plane.normal.y);
+                const auto c = Batch::broadcast(plane.normal.z);
+                const auto d = Batch::broadcast(plane.distance);
+                const auto zero = Batch::broadcast(0);
+
+                const auto p_distance = a * Batch::load(&px[i]) + b * Batch::load(&py[i]) + c * Batch::load(&pz[i]) + d;
+                const auto n_distance = a * Batch::load(&nx[i]) + b * Batch::load(&ny[i]) + c * Batch::load(&nz[i]) + d;
+                outside = outside | (p_distance < zero);
+                intersecting = intersecting | (n_distance < zero);
+            }
+            const auto outside_bits = bits(outside);
+            const auto intersecting_bits = bits(intersecting);
+            for (size_t l = 0; l < width; ++l) {
+                if (outside_bits & (1u << l))
+                    out[i + l] = Classification::Outside;
+                else if (intersecting_bits & (1u << l))
+                    out[i + l] = Classification::Intersecting;
+                else
+                    out[i + l] = Classification::Inside;
+            }
+        }
+    }
+    template <typename Batch, typename T>
+    void projected_area_bound_range(const AabbBatch<3, T>& boxes, const glm::tmat4x4<T>& m, size_t begin, size_t end, T* out)
+    {
+        constexpr auto width = Batch::width;
+        const auto zero = Batch::broadcast(0);
+        const auto one = Batch::broadcast(1);
+        for (size_t i = begin; i + width <= end; i += width) {
+            const std::array<Batch, 2> x = { Batch::load(&boxes.min[0][i]), Batch::load(&boxes.max[0][i]) };
+            const std::array<Batch, 2> y = { Batch::load(&boxes.min[1][i]), Batch::load(&boxes.max[1][i]) };
+            const std::array<Batch, 2> z = { Batch::load(&boxes.min[2][i]), Batch::load(&boxes.max[2][i]) };
+            auto min_x = Batch::broadcast(std::numeric_limits<T>::max());
+            auto min_y = min_x;
+            auto max_x = Batch::broadcast(std::numeric_limits<T>::lowest());
+            auto max_y = max_x;
+            auto behind_near_plane = Batch::Mask::none();
+            for (unsigned corner = 0; corner < 8; ++corner) {
+                const auto& cx = x[corner & 1];
+                const auto& cy = y[(corner >> 1) & 1];
+                const auto& cz = z[(corner >> 2) & 1];
+                const auto row = [&](int r) {
+                    return Batch::broadcast(m[0][r]) * cx + Batch::broadcast(m[1][r]) * cy + Batch::broadcast(m[2][r]) * cz + Batch::broadcast(m[3][r]);
+                };
+                const auto clip_w = row(3);
+                behind_near_plane = behind_near_plane | (row(2) + clip_w < zero);
+                const auto ndc_x = row(0) / clip_w;
+                const auto ndc_y = row(1) / clip_w;
+                min_x = min(min_x, ndc_x);
+                min_y = min(min_y, ndc_y);
+                max_x = max(max_x, ndc_x);
+                max_y = max(max_y, ndc_y);
+            }
+            min_x = max(min_x, zero - one);
+            min_y = max(min_y, zero - one);
+            max_x = min(max_x, one);
+            max_y = min(max_y, one);
+            const auto area = max(max_x - min_x, zero) * max(max_y - min_y, zero);
+            select(behind_near_plane, Batch::broadcast(4), area).store(out + i);
+        }
+    }
+    template <typename Batch>
+    void store_mask(typename Batch::Mask mask, bool* out)
+    {
+        const auto mask_bits = bits(mask);
+        for (size_t l = 0; l < Batch::width; ++l)
+            out[l] = mask_bits & (1u << l);
+    }
+
+    template <typename Batch, glm::length_t n_dims, typename T>
+    void intersect_range(const AabbBatch<n_dims, T>& boxes, const Aabb<n_dims, T>& box, size_t begin, size_t end, bool* out)
+    {
+        for (size_t i = begin; i + Batch::width <= end; i += Batch::width) {
+            auto disjoint = Batch::Mask::none();
+            for (glm::length_t d = 0; d < n_dims; ++d) {
+                disjoint = disjoint | (Batch::load(&boxes.min[d][i]) > Batch::broadcast(box.max[d]));
+                disjoint = disjoint | (Batch::broadcast(box.min[d]) > Batch::load(&boxes.max[d][i]));
+            }
+            store_mask<Batch>(!disjoint, out + i);
+        }
+    }
+
+    template <typename Batch, glm::length_t n_dims, typename T>
+    void contains_range(const AabbBatch<n_dims, T>& boxes, const glm::vec<n_dims, T>& point, size_t begin, size_t end, bool* out)
+    {
+        for (size_t i = begin; i + Batch::width <= end; i += Batch::width) {
+            auto outside = Batch::Mask::none();
+            for (glm::length_t d = 0; d < n_dims; ++d) {
+                const auto p = Batch::broadcast(point[d]);
+                outside = outside | (Batch::load(&boxes.min[d][i]) > p) | (Batch::load(&boxes.max[d][i]) <= p);
+            }
+            store_mask<Batch>(!outside, out + i);
+        }
+    }
+
+    template <typename Batch, glm::length_t n_dims, typename T>
+    void distance_sq_range(const AabbBatch<n_dims, T>& boxes, const glm::vec<n_dims, T>& point, size_t begin, size_t end, T* out)
+    {
+        const auto zero = Batch::broadcast(0);
+        for (size_t i = begin; i + Batch::width <= end; i += Batch::width) {
+            auto distance_squared = zero;
+            for (glm::length_t d = 0; d < n_dims; ++d) {
+                const auto p = Batch::broadcast(point[d]);
+                // at most one of the differences is positive for a valid box
+                const auto value = max(max(Batch::load(&boxes.min[d][i]) - p, p - Batch::load(&boxes.max[d][i])), zero);
+                distance_squared = distance_squared + value * value;
+            }
+            distance_squared.store(out + i);
+        }
+    }
+
+    template <typename Batch, glm::length_t n_dims, typename T>
+    void expand_by_range(const AabbBatch<n_dims, T>& boxes, size_t begin, size_t end, Aabb<n_dims, T>* bounds)
+    {
+        if (begin + Batch::width > end)
+            return;
+        std::array<Batch, n_dims> lower;
+        std::array<Batch, n_dims> upper;
+        for (glm::length_t d = 0; d < n_dims; ++d) {
+            lower[d] = Batch::broadcast(bounds->min[d]);
+            upper[d] = Batch::broadcast(bounds->max[d]);
+        }
+        for (size_t i = begin; i + Batch::width <= end; i += Batch::width) {
+            for (glm::length_t d = 0; d < n_dims; ++d) {
+                lower[d] = min(lower[d], Batch::load(&boxes.min[d][i]));
+                upper[d] = max(upper[d], Batch::load(&boxes.max[d][i]));
+            }
+        }
+        std::array<T, Batch::width> lower_lanes;
+        std::array<T, Batch::width> upper_lanes;
+        for (glm::length_t d = 0; d < n_dims; ++d) {
+            lower[d].store(lower_lanes.data());
+            upper[d].store(upper_lanes.data());
+            for (size_t l = 0; l < Batch::width; ++l) {
+                bounds->min[d] = std::min(bounds->min[d], lower_lanes[l]);
+                bounds->max[d] = std::max(bounds->max[d], upper_lanes[l]);
+            }
+        }
+    }
+} // namespace detail
+
+/// batched version of classify(Aabb, planes), results are identical to the scalar version.
+/// out must have the same size as boxes.
+template <typename T, typename PlaneContainer>
+void classify(const AabbBatch<3, T>& boxes, const PlaneContainer& planes, std::span<Classification> out)
+{
+    assert(out.size() == boxes.size());
+    using Batch = simd::Batch<T>;
+    const auto n_simd = boxes.size() - boxes.size() % Batch::width;
+    detail::classify_range<Batch>(boxes, planes, 0, n_simd, out.data());
+    detail::classify_range<simd::Scalar<T>>(boxes, planes, n_simd, boxes.size(), out.data());
+}
+
+/// batched version of projected_area_bound(Aabb, view_projection). out must have the same size as boxes.
+template <typename T>
+void projected_area_bound(const AabbBatch<3, T>& boxes, const glm::tmat4x4<T>& view_projection, std::span<T> out)
+{
+    assert(out.size() == boxes.size());
+    using Batch = simd::Batch<T>;
+    const auto n_simd = boxes.size() - boxes.size() % Batch::width;
+    detail::projected_area_bound_range<Batch>(boxes, view_projection, 0, n_simd, out.data());
+    detail::projected_area_bound_range<simd::Scalar<T>>(boxes, view_projection, n_simd, boxes.size(), out.data());
+}
+
+/// batched intersect(Aabb, Aabb): out[i] = intersect(boxes[i], box). out must have the same size as boxes.
+template <glm::length_t n_dims, typename T>
+void intersect(const AabbBatch<n_dims, T>& boxes, const Aabb<n_dims, T>& box, std::span<bool> out)
+{
+    assert(out.size() == boxes.size());
+    using Batch = simd::Batch<T>;
+    const auto n_simd = boxes.size() - boxes.size() % Batch::width;
+    detail::intersect_range<Batch>(boxes, box, 0, n_simd, out.data());
+    detail::intersect_range<simd::Scalar<T>>(boxes, box, n_simd, boxes.size(), out.data());
+}
+
+/// batched Aabb::contains (min inclusive, max exclusive): out[i] = boxes[i].contains(point).
+template <glm::length_t n_dims, typename T>
+void contains(const AabbBatch<n_dims, T>& boxes, const glm::vec<n_dims, T>& point, std::span<bool> out)
+{
+    assert(out.size() == boxes.size());
+    using Batch = simd::Batch<T>;
+    const auto n_simd = boxes.size() - boxes.size() % Batch::width;
+    detail::contains_range<Batch>(boxes, point, 0, n_simd, out.data());
+    detail::contains_range<simd::Scalar<T>>(boxes, point, n_simd, boxes.size(), out.data());
+}
+
+/// batched distance_sq(Aabb, point): out[i] = distance_sq(boxes[i], point).
+template <glm::length_t n_dims, typename T>
+void distance_sq(const AabbBatch<n_dims, T>& boxes, const glm::vec<n_dims, T>& point, std::span<T> out)
+{
+    assert(out.size() == boxes.size());
+    using Batch = simd::Batch<T>;
+    const auto n_simd = boxes.size() - boxes.size() % Batch::width;
+    detail::distance_sq_range<Batch>(boxes, point, 0, n_simd, out.data());
+    detail::distance_sq_range<simd::Scalar<T>>(boxes, point, n_simd, boxes.size(), out.data());
+}
+
+/// union of all boxes (i.e., Aabb::expand_by for each of them). an empty batch results in a default constructed (invalid) box.
+template <glm::length_t n_dims, typename T>
+Aabb<n_dims, T> find_bounds(const AabbBatch<n_dims, T>& boxes)
+{
+    using Batch = simd::Batch<T>;
+    const auto n_simd = boxes.size() - boxes.size() % Batch::width;
+    Aabb<n_dims, T> bounds;
+    detail::expand_by_range<Batch>(boxes, 0, n_simd, &bounds);
+    detail::expand_by_range<simd::Scalar<T>>(boxes, n_simd, boxes.size(), &bounds);
+    return bounds;
+}
+
+} // namespace radix::geometry
@@ -0,0 +1,322 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include "height_encoding.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+// the simd versions are compiled with target attributes, so that they are available without -mavx2 and chosen at
+// runtime. other compilers get them only if the instruction set is enabled at compile time.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define RADIX_HEIGHT_ENCODING_DISPATCH 1
+#define RADIX_HEIGHT_ENCODING_SSE41 1
+#define RADIX_HEIGHT_ENCODING_AVX2 1
+#define RADIX_TARGET(isa) __attribute__((target(isa)))
+#else
+#if defined(__AVX2__)
+#define RADIX_HEIGHT_ENCODING_AVX2 1
+#endif
+#if defined(__AVX__) || defined(__SSE4_1__)
+#define RADIX_HEIGHT_ENCODING_SSE41 1
+#endif
+#define RADIX_TARGET(isa)
+#endif
+
+#if defined(RADIX_HEIGHT_ENCODING_SSE41) || defined(RADIX_HEIGHT_ENCODING_AVX2)
+#include <immintrin.h>
+#endif
+
+static_assert(sizeof(glm::u8vec3) == 3);
+
+namespace {
+using namespace radix::height_encoding;
+
+constexpr float encode_factor = 65535.f / (max_height - min_height);
+constexpr float decode_factor = (max_height - min_height) / 65535.f;
+
+// 4 pixels are 12 bytes of rgb. encoding goes through a 16 byte buffer and decoding stops early enough for 16 byte
+// loads, so the simd versions never touch memory outside of the spans.
+constexpr size_t pixels_per_chunk = 4;
+constexpr size_t chunk_bytes = 3 * pixels_per_chunk;
+
+void encode_scalar(std::span<const float> heights, glm::u8vec3* rgb)
+{
+    for (size_t i = 0; i < heights.size(); ++i)
+        rgb[i] = to_rgb(heights[i]);
+}
+
+void decode_scalar(std::span<const glm::u8vec3> rgb, float* heights)
+{
+    for (size_t i = 0; i < rgb.size(); ++i)
+        heights[i] = to_float(rgb[i]);
+}
+
+// min / max are tracked on the 16 bit encoded values, to_float is monotonic. heights may be null (no output).
+void decode_min_max_scalar(std::span<const glm::u8vec3> rgb, float* heights, uint32_t* min, uint32_t* max)
+{
+    for (size_t i = 0; i < rgb.size(); ++i) {
+        const auto encoded = uint32_t(rgb[i].x) << 8 | rgb[i].y;
+        *min = std::min(*min, encoded);
+        *max = std::max(*max, encoded);
+        if (heights)
+            heights[i] = to_float(rgb[i]);
+    }
+}
+
+#if defined(RADIX_HEIGHT_ENCODING_SSE41)
+// lround: round half away from zero. the fractional part of a float is exact, so this matches std::lround.
+RADIX_TARGET("sse4.1") __m128i lround(__m128 v)
+{
+    const auto truncated = _mm_round_ps(v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    const auto fraction = _mm_sub_ps(v, truncated);
+    const auto up = _mm_and_ps(_mm_cmpge_ps(fraction, _mm_set1_ps(0.5f)), _mm_set1_ps(1.f));
+    const auto down = _mm_and_ps(_mm_cmple_ps(fraction, _mm_set1_ps(-0.5f)), _mm_set1_ps(1.f));
+    return _mm_cvttps_epi32(_mm_sub_ps(_mm_add_ps(truncated, up), down));
+}
+
+// (r, g, 0) from the 32 bit lanes, r is the second and g the lowest byte
+RADIX_TARGET("sse4.1") __m128i pack_rgb(__m128i scaled) { return _mm_shuffle_epi8(scaled, _mm_setr_epi8(1, 0, -1, 5, 4, -1, 9, 8, -1, 13, 12, -1, -1, -1, -1, -1)); }
+
+// (r << 8 | g) in 32 bit lanes
+RADIX_TARGET("sse4.1") __m128i unpack_rgb(__m128i bytes) { return _mm_shuffle_epi8(bytes, _mm_setr_epi8(1, 0, -1, -1, 4, 3, -1, -1, 7, 6, -1, -1, 10, 9, -1, -1)); }
+
+RADIX_TARGET("sse4.1") size_t encode_sse41(std::span<const float> heights, glm::u8vec3* rgb)
+{
+    const auto n_simd = heights.size() - heights.size() % pixels_per_chunk;
+    alignas(16) std::byte buffer[16];
+    for (size_t i = 0; i < n_simd; i += pixels_per_chunk) {
+        const auto height = _mm_sub_ps(_mm_loadu_ps(heights.data() + i), _mm_set1_ps(min_height));
+        _mm_store_si128(reinterpret_cast<__m128i*>(buffer), pack_rgb(lround(_mm_mul_ps(height, _mm_set1_ps(encode_factor)))));
+        std::memcpy(rgb + i, buffer, chunk_bytes);
+    }
+    return n_simd;
+}
+
+RADIX_TARGET("sse4.1") size_t decode_sse41(std::span<const glm::u8vec3> rgb, float* heights)
+{
+    // loads 16 bytes for 12 bytes of pixels directly from the span, the last pixels are left to the scalar tail
+    const auto n_simd = rgb.size() < 6 ? 0 : (rgb.size() - 6) / pixels_per_chunk * pixels_per_chunk + pixels_per_chunk;
+    const auto* bytes = reinterpret_cast<const std::byte*>(rgb.data());
+    for (size_t i = 0; i < n_simd; i += pixels_per_chunk) {
+        const auto encoded = _mm_cvtepi32_ps(unpack_rgb(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 3 * i))));
+        _mm_storeu_ps(heights + i, _mm_add_ps(_mm_mul_ps(encoded, _mm_set1_ps(decode_factor)), _mm_set1_ps(min_height)));
+    }
+    return n_simd;
+}
+
+RADIX_TARGET("sse4.1") size_t decode_min_max_sse41(std::span<const glm::u8vec3> rgb, float* heights, uint32_t* min, uint32_t* max)
+{
+    const auto n_simd = rgb.size() < 6 ? 0 : (rgb.size() - 6) / pixels_per_chunk * pixels_per_chunk + pixels_per_chunk;
+    const auto* bytes = reinterpret_cast<const std::byte*>(rgb.data());
+    auto min_lanes = _mm_set1_epi32(int(*min));
+    auto max_lanes = _mm_set1_epi32(int(*max));
+    for (size_t i = 0; i < n_simd; i += pixels_per_chunk) {
+        const auto encoded = unpack_rgb(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 3 * i)));
+        min_lanes = _mm_min_epi32(min_lanes, encoded);
+        max_lanes = _mm_max_epi32(max_lanes, encoded);
+        if (heights)
+            _mm_storeu_ps(heights + i, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(encoded), _mm_set1_ps(decode_factor)), _mm_set1_ps(min_height)));
+    }
+    alignas(16) uint32_t lanes[2][4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes[0]), min_lanes);
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes[1]), max_lanes);
+    *min = *std::min_element(lanes[0], lanes[0] + 4);
+    *max = *std::max_element(lanes[1], lanes[1] + 4);
+    return n_simd;
+}
+#endif
+
+#if defined(RADIX_HEIGHT_ENCODING_AVX2)
+RADIX_TARGET("avx2") __m256i lround(__m256 v)
+{
+    const auto truncated = _mm256_round_ps(v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    const auto fraction = _mm256_sub_ps(v, truncated);
+    const auto up = _mm256_and_ps(_mm256_cmp_ps(fraction, _mm256_set1_ps(0.5f), _CMP_GE_OQ), _mm256_set1_ps(1.f));
+    const auto down = _mm256_and_ps(_mm256_cmp_ps(fraction, _mm256_set1_ps(-0.5f), _CMP_LE_OQ), _mm256_set1_ps(1.f));
+    return _mm256_cvttps_epi32(_mm256_sub_ps(_mm256_add_ps(truncated, up), down));
+}
+
+// 8 pixels per iteration, the byte shuffles work on the two 128 bit halves (4 pixels each)
+RADIX_TARGET("avx2") size_t encode_avx2(std::span<const float> heights, glm::u8vec3* rgb)
+{
+    constexpr size_t width = 2 * pixels_per_chunk;
+    const auto n_simd = heights.size() - heights.size() % width;
+    const auto shuffle = _mm256_setr_epi8(1, 0, -1, 5, 4, -1, 9, 8, -1, 13, 12, -1, -1, -1, -1, -1, //
+        1, 0, -1, 5, 4, -1, 9, 8, -1, 13, 12, -1, -1, -1, -1, -1);
+    alignas(32) std::byte buffer[32];
+    for (size_t i = 0; i < n_simd; i += width) {
+        const auto height = _mm256_sub_ps(_mm256_loadu_ps(heights.data() + i), _mm256_set1_ps(min_height));
+        const auto scaled = lround(_mm256_mul_ps(height, _mm256_set1_ps(encode_factor)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(buffer), _mm256_shuffle_epi8(scaled, shuffle));
+        std::memcpy(rgb + i, buffer, chunk_bytes);
+        std::memcpy(rgb + i + pixels_per_chunk, buffer + 16, chunk_bytes);
+    }
+    return n_simd;
+}
+
+RADIX_TARGET("avx2") size_t decode_avx2(std::span<const glm::u8vec3> rgb, float* heights)
+{
+    constexpr size_t width = 2 * pixels_per_chunk;
+    const auto n_simd = rgb.size() < 10 ? 0 : (rgb.size() - 10) / width * width + width;
+    const auto shuffle = _mm256_setr_epi8(1, 0, -1, -1, 4, 3, -1, -1, 7, 6, -1, -1, 10, 9, -1, -1, //
+        1, 0, -1, -1, 4, 3, -1, -1, 7, 6, -1, -1, 10, 9, -1, -1);
+    const auto* bytes = reinterpret_cast<const std::byte*>(rgb.data());
+    for (size_t i = 0; i < n_simd; i += width) {
+        const auto low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 3 * i));
+        const auto high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 3 * (i + pixels_per_chunk)));
+        const auto encoded = _mm256_cvtepi32_ps(_mm256_shuffle_epi8(_mm256_set_m128i(high, low), shuffle));
+        _mm256_storeu_ps(heights + i, _mm256_add_ps(_mm256_mul_ps(encoded, _mm256_set1_ps(decode_factor)), _mm256_set1_ps(min_height)));
+    }
+    return n_simd;
+}
+
+RADIX_TARGET("avx2") size_t decode_min_max_avx2(std::span<const glm::u8vec3> rgb, float* heights, uint32_t* min, uint32_t* max)
+{
+    constexpr size_t width = 2 * pixels_per_chunk;
+    const auto n_simd = rgb.size() < 10 ? 0 : (rgb.size() - 10) / width * width + width;
+    const auto shuffle = _mm256_setr_epi8(1, 0, -1, -1, 4, 3, -1, -1, 7, 6, -1, -1, 10, 9, -1, -1, //
+        1, 0, -1, -1, 4, 3, -1, -1, 7, 6, -1, -1, 10, 9, -1, -1);
+    const auto* bytes = reinterpret_cast<const std::byte*>(rgb.data());
+    auto min_lanes = _mm256_set1_epi32(int(*min));
+    auto max_lanes = _mm256_set1_epi32(int(*max));
+    for (size_t i = 0; i < n_simd; i += width) {
+        const auto low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 3 * i));
+        const auto high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 3 * (i + pixels_per_chunk)));
+        const auto encoded = _mm256_shuffle_epi8(_mm256_set_m128i(high, low), shuffle);
+        min_lanes = _mm256_min_epi32(min_lanes, encoded);
+        max_lanes = _mm256_max_epi32(max_lanes, encoded);
+        if (heights)
+            _mm256_storeu_ps(heights + i, _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(encoded), _mm256_set1_ps(decode_factor)), _mm256_set1_ps(min_height)));
+    }
+    alignas(32) uint32_t lanes[2][8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[0]), min_lanes);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[1]), max_lanes);
+    *min = *std::min_element(lanes[0], lanes[0] + 8);
+    *max = *std::max_element(lanes[1], lanes[1] + 8);
+    return n_simd;
+}
+#endif
+
+} // namespace
+
+namespace radix::height_encoding {
+
+bool is_supported(Implementation implementation)
+{
+    switch (implementation) {
+    case Implementation::Scalar:
+        return true;
+    case Implementation::Sse41:
+#if defined(RADIX_HEIGHT_ENCODING_DISPATCH)
+        return __builtin_cpu_supports("sse4.1");
+#elif defined(RADIX_HEIGHT_ENCODING_SSE41)
+        return true;
+#else
+        return false;
+#endif
+    case Implementation::Avx2:
+#if defined(RADIX_HEIGHT_ENCODING_DISPATCH)
+        return __builtin_cpu_supports("avx2");
+#elif defined(RADIX_HEIGHT_ENCODING_AVX2)
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+Implementation best_implementation()
+{
+    static const auto best = []() {
+        if (is_supported(Implementation::Avx2))
+            return Implementation::Avx2;
+        if (is_supported(Implementation::Sse41))
+            return Implementation::Sse41;
+        return Implementation::Scalar;
+    }();
+    return best;
+}
+
+void encode(std::span<const float> heights, std::span<glm::u8vec3> rgb) { encode(heights, rgb, best_implementation()); }
+
+void encode(std::span<const float> heights, std::span<glm::u8vec3> rgb, Implementation implementation)
+{
+    assert(heights.size() == rgb.size());
+    assert(is_supported(implementation));
+    size_t n_processed = 0;
+#if defined(RADIX_HEIGHT_ENCODING_AVX2)
+    if (implementation == Implementation::Avx2)
+        n_processed = encode_avx2(heights, rgb.data());
+#endif
+#if defined(RADIX_HEIGHT_ENCODING_SSE41)
+    if (implementation == Implementation::Sse41)
+        n_processed = encode_sse41(heights, rgb.data());
+#endif
+    encode_scalar(heights.subspan(n_processed), rgb.data() + n_processed);
+}
+
+void decode(std::span<const glm::u8vec3> rgb, std::span<float> heights) { decode(rgb, heights, best_implementation()); }
+
+void decode(std::span<const glm::u8vec3> rgb, std::span<float> heights, Implementation implementation)
+{
+    assert(heights.size() == rgb.size());
+    assert(is_supported(implementation));
+    size_t n_processed = 0;
+#if defined(RADIX_HEIGHT_ENCODING_AVX2)
+    if (implementation == Implementation::Avx2)
+        n_processed = decode_avx2(rgb, heights.data());
+#endif
+#if defined(RADIX_HEIGHT_ENCODING_SSE41)
+    if (implementation == Implementation::Sse41)
+        n_processed = decode_sse41(rgb, heights.data());
+#endif
+    decode_scalar(rgb.subspan(n_processed), heights.data() + n_processed);
+}
+
+std::pair<float, float> decode_min_max(std::span<const glm::u8vec3> rgb, std::span<float> heights)
+{
+    return decode_min_max(rgb, heights, best_implementation());
+}
+
+std::pair<float, float> decode_min_max(std::span<const glm::u8vec3> rgb, std::span<float> heights, Implementation implementation)
+{
+    assert(!rgb.empty());
+    assert(heights.empty() || heights.size() == rgb.size());
+    assert(is_supported(implementation));
+    auto* out = heights.empty() ? nullptr : heights.data();
+    auto min = uint32_t(65535);
+    auto max = uint32_t(0);
+    size_t n_processed = 0;
+#if defined(RADIX_HEIGHT_ENCODING_AVX2)
+    if (implementation == Implementation::Avx2)
+        n_processed = decode_min_max_avx2(rgb, out, &min, &max);
+#endif
+#if defined(RADIX_HEIGHT_ENCODING_SSE41)
+    if (implementation == Implementation::Sse41)
+        n_processed = decode_min_max_sse41(rgb, out, &min, &max);
+#endif
+    decode_min_max_scalar(rgb.subspan(n_processed), out ? out + n_processed : nullptr, &min, &max);
+    const auto as_rgb = [](uint32_t encoded) { return glm::u8vec3(encoded >> 8, encoded & 255, 0); };
+    return { to_float(as_rgb(min)), to_float(as_rgb(max)) };
+}
+
+} // namespace radix::height_encoding
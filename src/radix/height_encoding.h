@@ -20,6 +20,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <span>
+#include <utility>
 #include <glm/glm.hpp>
 
 namespace radix::height_encoding {
@@ -45,4 +47,22 @@ inline float to_float(glm::u8vec3 v)
     return float(v.x << 8 | v.y) * scaling_factor + min_height;
 }
 
+// Kernels for whole tiles. The results are bit identical to to_rgb / to_float for every element (for encode: as long as
+// the scaled height fits into 31 bits, i.e., for |height| < 2.6e8 m, and it's not NaN). The implementation is chosen at
+// runtime (AVX2 and SSE4.1 on x86 with gcc or clang, scalar otherwise), or can be forced for testing.
+enum class Implementation { Scalar, Sse41, Avx2 };
+
+[[nodiscard]] bool is_supported(Implementation implementation);
+[[nodiscard]] Implementation best_implementation();
+
+void encode(std::span<const float> heights, std::span<glm::u8vec3> rgb);
+void encode(std::span<const float> heights, std::span<glm::u8vec3> rgb, Implementation implementation);
+void decode(std::span<const glm::u8vec3> rgb, std::span<float> heights);
+void decode(std::span<const glm::u8vec3> rgb, std::span<float> heights, Implementation implementation);
+
+/// decodes and returns (min, max) in a single pass over rgb. heights is either empty (only min / max are computed) or
+/// has the same size as rgb, which must not be empty.
+std::pair<float, float> decode_min_max(std::span<const glm::u8vec3> rgb, std::span<float> heights);
+std::pair<float, float> decode_min_max(std::span<const glm::u8vec3> rgb, std::span<float> heights, Implementation implementation);
+
 } // namespace radix::height_encoding
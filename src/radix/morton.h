@@ -0,0 +1,109 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// 2d Morton (Z-order) codes for 32 bit coordinates. x is stored in the even bits, y in the odd bits.
+
+namespace radix::morton {
+
+namespace detail {
+    constexpr uint64_t x_bits = 0x5555'5555'5555'5555ull;
+    constexpr uint64_t y_bits = 0xAAAA'AAAA'AAAA'AAAAull;
+
+    constexpr uint64_t spread(uint64_t v)
+    {
+        v &= 0xFFFF'FFFFull;
+        v = (v | (v << 16)) & 0x0000'FFFF'0000'FFFFull;
+        v = (v | (v << 8)) & 0x00FF'00FF'00FF'00FFull;
+        v = (v | (v << 4)) & 0x0F0F'0F0F'0F0F'0F0Full;
+        v = (v | (v << 2)) & 0x3333'3333'3333'3333ull;
+        v = (v | (v << 1)) & 0x5555'5555'5555'5555ull;
+        return v;
+    }
+
+    constexpr uint32_t compact(uint64_t v)
+    {
+        v &= 0x5555'5555'5555'5555ull;
+        v = (v | (v >> 1)) & 0x3333'3333'3333'3333ull;
+        v = (v | (v >> 2)) & 0x0F0F'0F0F'0F0F'0F0Full;
+        v = (v | (v >> 4)) & 0x00FF'00FF'00FF'00FFull;
+        v = (v | (v >> 8)) & 0x0000'FFFF'0000'FFFFull;
+        v = (v | (v >> 16)) & 0x0000'0000'FFFF'FFFFull;
+        return uint32_t(v);
+    }
+
+    // the lower bits of the same dimension as bit
+    constexpr uint64_t lower_bits_of_dimension(unsigned bit)
+    {
+        return (bit % 2 ? y_bits : x_bits) & ((uint64_t(1) << bit) - 1);
+    }
+} // namespace detail
+
+constexpr uint64_t encode(const glm::uvec2& coords) { return detail::spread(coords.x) | (detail::spread(coords.y) << 1); }
+
+constexpr glm::uvec2 decode(uint64_t code) { return { detail::compact(code), detail::compact(code >> 1) }; }
+
+/// mask of the codes of a 2^zoom_level x 2^zoom_level grid
+constexpr uint64_t level_mask(unsigned zoom_level) { return zoom_level >= 32 ? ~uint64_t(0) : (uint64_t(1) << (2 * zoom_level)) - 1; }
+
+/// neighbouring cells by carry propagation through the bits of one dimension, wrapping at 2^32. mask with level_mask()
+/// to wrap on a smaller grid.
+constexpr uint64_t increment_x(uint64_t code) { return (((code | detail::y_bits) + 1) & detail::x_bits) | (code & detail::y_bits); }
+constexpr uint64_t decrement_x(uint64_t code) { return (((code & detail::x_bits) - 1) & detail::x_bits) | (code & detail::y_bits); }
+constexpr uint64_t increment_y(uint64_t code) { return (((code | detail::x_bits) + 1) & detail::y_bits) | (code & detail::x_bits); }
+constexpr uint64_t decrement_y(uint64_t code) { return (((code & detail::y_bits) - 1) & detail::y_bits) | (code & detail::x_bits); }
+
+/// true if the decoded code lies inside the rectangle spanned by the codes of its min and max corner (inclusive).
+constexpr bool in_rect(uint64_t code, uint64_t min, uint64_t max)
+{
+    const auto x = code & detail::x_bits;
+    const auto y = code & detail::y_bits;
+    return x >= (min & detail::x_bits) && x <= (max & detail::x_bits) && y >= (min & detail::y_bits) && y <= (max & detail::y_bits);
+}
+
+/// the smallest code that is larger than code and inside the rectangle spanned by min and max (BIGMIN, Tropf and Herzog
+/// 1981). code must be outside of the rectangle and smaller than max.
+constexpr uint64_t next_in_rect(uint64_t code, uint64_t min, uint64_t max)
+{
+    uint64_t result = 0;
+    for (unsigned bit = 64; bit-- > 0;) {
+        const auto mask = uint64_t(1) << bit;
+        const auto lower = detail::lower_bits_of_dimension(bit);
+        const auto c = (code & mask) != 0;
+        const auto lo = (min & mask) != 0;
+        const auto hi = (max & mask) != 0;
+        if (!c && !lo && hi) {
+            result = (min & ~lower) | mask; // the smallest code in the upper half
+            max = (max & ~mask) | lower; // continue in the lower half
+        } else if (!c && lo && hi) {
+            return min;
+        } else if (c && !lo && !hi) {
+            return result;
+        } else if (c && !lo && hi) {
+            min = (min & ~lower) | mask;
+        }
+    }
+    return result;
+}
+
+} // namespace radix::morton
@@ -21,10 +21,19 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 #include <iterator>
 
+#include "generator.h"
+
 using std::size_t;
 
 // This is a quick implementation of a quad tree.
@@ -76,6 +85,126 @@ std::vector<DataType> onTheFlyTraverse(const DataType& root, const PredicateFunc
     return leaves;
 }
 
+// Lazy version of onTheFlyTraverse. Yields the same leaves in the same order, but predicate and generate_children
+// are only called as far as the consumer iterates, i.e., stopping early (break, or destroying the generator) is cheap.
+// Arguments are taken by value, as the generator may outlive the caller's scope. Use std::ref for stateful functors.
+template <typename DataType, typename PredicateFunction, typename RefineFunction>
+generator<DataType> onTheFlyTraverseLazy(DataType root, PredicateFunction predicate, RefineFunction generate_children)
+{
+    std::vector<DataType> stack;
+    stack.push_back(std::move(root));
+    while (!stack.empty()) {
+        const DataType node = std::move(stack.back());
+        stack.pop_back();
+        if (!predicate(node)) {
+            co_yield node;
+            continue;
+        }
+        // reversed, so that the first child is popped first
+        const auto children = generate_children(node);
+        std::copy(children.rbegin(), children.rend(), std::back_inserter(stack));
+    }
+}
+
+// Breadth first version of onTheFlyTraverse. The predicate is called once per level with the whole frontier,
+// which allows batched (e.g., SIMD) frustum or lod tests:
+//     void batch_predicate(std::span<const DataType> frontier, std::span<bool> needs_refinement);
+// needs_refinement has the same size as frontier and must be written completely.
+// Returns the same leaves as onTheFlyTraverse, but ordered level by level (coarse to fine), and within a level in the
+// order of generate_children.
+template <typename DataType, typename BatchPredicateFunction, typename RefineFunction>
+std::vector<DataType> onTheFlyTraverseBreadthFirst(const DataType& root, const BatchPredicateFunction& batch_predicate, const RefineFunction& generate_children)
+{
+    std::vector<DataType> leaves;
+    std::vector<DataType> frontier = { root };
+    std::vector<DataType> next_frontier;
+    // std::vector<bool> can't be viewed by a span
+    std::unique_ptr<bool[]> needs_refinement;
+    size_t needs_refinement_capacity = 0;
+
+    while (!frontier.empty()) {
+        if (needs_refinement_capacity < frontier.size()) {
+            needs_refinement_capacity = std::max(frontier.size(), 2 * needs_refinement_capacity);
+            needs_refinement = std::make_unique<bool[]>(needs_refinement_capacity);
+        }
+        const auto refine_flags = std::span<bool>(needs_refinement.get(), frontier.size());
+        batch_predicate(std::span<const DataType>(frontier), refine_flags);
+
+        next_frontier.clear();
+        for (size_t i = 0; i < frontier.size(); ++i) {
+            if (!refine_flags[i]) {
+                leaves.push_back(frontier[i]);
+                continue;
+            }
+            const auto children = generate_children(frontier[i]);
+            std::copy(children.begin(), children.end(), std::back_inserter(next_frontier));
+        }
+        std::swap(frontier, next_frontier);
+    }
+    return leaves;
+}
+
+namespace detail {
+    struct NoNodeData { };
+
+    template <typename DataType, typename NodeDataFunction, typename PredicateContainer, typename RefineFunction>
+    void onTheFlyTraverseMultiView(const DataType& node, uint64_t active_views, const NodeDataFunction& compute_node_data, const PredicateContainer& predicates,
+        const RefineFunction& generate_children, std::vector<std::vector<DataType>>* leaves)
+    {
+        const auto node_data = compute_node_data(node);
+        uint64_t refining_views = 0;
+        size_t view = 0;
+        for (const auto& predicate : predicates) {
+            const auto view_bit = uint64_t(1) << view;
+            if (active_views & view_bit) {
+                bool refine = false;
+                if constexpr (std::is_same_v<std::remove_cvref_t<decltype(node_data)>, NoNodeData>)
+                    refine = predicate(node);
+                else
+                    refine = predicate(node, node_data);
+                if (refine)
+                    refining_views |= view_bit;
+                else
+                    (*leaves)[view].push_back(node);
+            }
+            ++view;
+        }
+        if (!refining_views)
+            return;
+        const auto children = generate_children(node);
+        for (const auto& child : children)
+            onTheFlyTraverseMultiView(child, refining_views, compute_node_data, predicates, generate_children, leaves);
+    }
+} // namespace detail
+
+// Traverses once for several views (e.g., main camera, shadow cascades, minimap). compute_node_data(node) is called once
+// per visited node, its result is passed to the predicates of all views as predicate(node, node_data). Use it for the
+// work that doesn't depend on the view (e.g., the bounds of a tile from TileHeights). predicates contains one predicate
+// per view, at most 64 (std::length_error is thrown otherwise). Every node is visited once, only predicates of views
+// that still refine are evaluated, and children are generated once for all views. Returns the leaves per view, in the
+// same order as onTheFlyTraverse would.
+template <typename DataType, typename NodeDataFunction, typename PredicateContainer, typename RefineFunction>
+std::vector<std::vector<DataType>> onTheFlyTraverseMultiView(
+    const DataType& root, const NodeDataFunction& compute_node_data, const PredicateContainer& predicates, const RefineFunction& generate_children)
+{
+    const auto n_views = size_t(std::distance(std::begin(predicates), std::end(predicates)));
+    if (n_views > 64)
+        throw std::length_error("onTheFlyTraverseMultiView supports at most 64 views");
+    std::vector<std::vector<DataType>> leaves(n_views);
+    if (n_views == 0)
+        return leaves;
+    const auto all_views = n_views == 64 ? ~uint64_t(0) : (uint64_t(1) << n_views) - 1;
+    detail::onTheFlyTraverseMultiView(root, all_views, compute_node_data, predicates, generate_children, &leaves);
+    return leaves;
+}
+
+// the same without shared node data, predicates are called as predicate(node).
+template <typename DataType, typename PredicateContainer, typename RefineFunction>
+std::vector<std::vector<DataType>> onTheFlyTraverseMultiView(const DataType& root, const PredicateContainer& predicates, const RefineFunction& generate_children)
+{
+    return onTheFlyTraverseMultiView(root, [](const DataType&) { return detail::NoNodeData {}; }, predicates, generate_children);
+}
+
 template <typename DataType, typename Function>
 void visit(Node<DataType>* root, const Function& visitor)
 {
@@ -175,6 +304,165 @@ void reduce(Node<DataType>* root, const PredicateFunction& node_needs_refinement
     }
 }
 
+namespace detail {
+    template <typename DataType>
+    std::vector<const Node<DataType>*> breadthFirstOrder(const Node<DataType>& root)
+    {
+        std::vector<const Node<DataType>*> nodes = { &root };
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (!nodes[i]->hasChildren())
+                continue;
+            for (const auto& child : *nodes[i])
+                nodes.push_back(child.get());
+        }
+        return nodes;
+    }
+
+    template <typename DataType>
+    std::vector<std::byte> serialiseTopology(const std::vector<const Node<DataType>*>& nodes, size_t payload_size_in_bytes)
+    {
+        const uint64_t n_nodes = nodes.size();
+        const auto n_bit_bytes = (n_nodes + 7) / 8;
+        std::vector<std::byte> bytes(sizeof(n_nodes) + n_bit_bytes + payload_size_in_bytes);
+        std::memcpy(bytes.data(), &n_nodes, sizeof(n_nodes));
+        auto* bits = bytes.data() + sizeof(n_nodes);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (nodes[i]->hasChildren())
+                bits[i / 8] |= std::byte(1u << (i % 8));
+        }
+        return bytes;
+    }
+
+    // calls add_children(node, payload_index) for every node with the children bit set, in breadth first order.
+    // the children get the next 4 payload indices. returns false if the stream is malformed.
+    template <typename DataType, typename AddChildrenFunction>
+    bool restoreTopology(Node<DataType>* root, const std::byte* bytes, size_t size_in_bytes, size_t payload_element_size, const AddChildrenFunction& add_children)
+    {
+        uint64_t n_nodes = 0;
+        if (size_in_bytes < sizeof(n_nodes))
+            return false;
+        std::memcpy(&n_nodes, bytes, sizeof(n_nodes));
+        if (n_nodes == 0 || n_nodes % 4 != 1 || n_nodes > (size_in_bytes - sizeof(n_nodes)) * 8)
+            return false;
+        if (size_in_bytes != sizeof(n_nodes) + (n_nodes + 7) / 8 + n_nodes * payload_element_size)
+            return false;
+
+        const auto* bits = bytes + sizeof(n_nodes);
+        root->removeChildren();
+        std::vector<Node<DataType>*> queue = { root };
+        queue.reserve(size_t(n_nodes));
+        for (size_t i = 0; i < queue.size(); ++i) {
+            if ((bits[i / 8] & std::byte(1u << (i % 8))) == std::byte(0))
+                continue;
+            if (queue.size() + 4 > n_nodes)
+                return false;
+            add_children(queue[i], queue.size());
+            for (auto& child : *queue[i])
+                queue.push_back(child.get());
+        }
+        return queue.size() == n_nodes;
+    }
+} // namespace detail
+
+// Serialises the shape of the tree (not the data) as a breadth first bit stream, 1 bit per node, set if the node has children.
+// Layout: uint64 node count, followed by the bits (lsb first), padded to full bytes.
+template <typename DataType>
+std::vector<std::byte> serialiseTopology(const Node<DataType>& root)
+{
+    return detail::serialiseTopology(detail::breadthFirstOrder(root), 0);
+}
+
+// Rebuilds the tree shape from serialiseTopology in a single breadth first pass. Existing children of root are removed,
+// node data is regenerated with generate_children, and no refinement predicate is evaluated.
+// Returns false (and leaves a partially restored tree) if the bytes are malformed.
+template <typename DataType, typename VectorOfBytes, typename RefineFunction>
+bool restoreTopology(Node<DataType>* root, const VectorOfBytes& bytes, const RefineFunction& generate_children)
+{
+    const auto add_children = [&](Node<DataType>* node, size_t) { node->addChildren(generate_children(node->data())); };
+    return detail::restoreTopology(root, reinterpret_cast<const std::byte*>(bytes.data()), size_t(bytes.size()), 0, add_children);
+}
+
+// Same as serialiseTopology, but the node data is appended in breadth first order. DataType must be trivially copyable.
+template <typename DataType>
+std::vector<std::byte> serialise(const Node<DataType>& root)
+{
+    static_assert(std::is_trivially_copyable_v<DataType>);
+    const auto nodes = detail::breadthFirstOrder(root);
+    auto bytes = detail::serialiseTopology(nodes, nodes.size() * sizeof(DataType));
+    auto* payload = bytes.data() + (bytes.size() - nodes.size() * sizeof(DataType));
+    for (const auto* node : nodes) {
+        std::memcpy(payload, &node->data(), sizeof(DataType));
+        payload += sizeof(DataType);
+    }
+    return bytes;
+}
+
+// Inverse of serialise. Returns an empty optional if the bytes are malformed.
+template <typename DataType, typename VectorOfBytes>
+std::optional<Node<DataType>> deserialise(const VectorOfBytes& bytes)
+{
+    static_assert(std::is_trivially_copyable_v<DataType>);
+    const auto* data = reinterpret_cast<const std::byte*>(bytes.data());
+    const auto size = size_t(bytes.size());
+    uint64_t n_nodes = 0;
+    if (size < sizeof(n_nodes))
+        return {};
+    std::memcpy(&n_nodes, data, sizeof(n_nodes));
+    if (n_nodes == 0 || n_nodes > size || size != sizeof(n_nodes) + (n_nodes + 7) / 8 + n_nodes * sizeof(DataType))
+        return {};
+    const auto* payload = data + (size - n_nodes * sizeof(DataType));
+    const auto read = [payload](size_t index) {
+        DataType value;
+        std::memcpy(&value, payload + index * sizeof(DataType), sizeof(DataType));
+        return value;
+    };
+
+    auto root = Node<DataType>(read(0));
+    const auto add_children = [&](Node<DataType>* node, size_t first_child_index) {
+        node->addChildren({ read(first_child_index), read(first_child_index + 1), read(first_child_index + 2), read(first_child_index + 3) });
+    };
+    if (!detail::restoreTopology(&root, data, size, sizeof(DataType), add_children))
+        return {};
+    return root;
+}
+
+// Moves a path (from pathTo below, or a previous moveTo) to the deepest node that covers a new target, without restarting
+// from the root: the path is shortened to the deepest common ancestor and extended from there, so a query for an
+// adjacent tile costs O(levels between the two nodes and their common ancestor).
+// Returns the new last node, or nullptr (leaving the path unchanged) if the root doesn't cover the target.
+template <typename DataType, typename CoversFunction>
+const Node<DataType>* moveTo(std::vector<const Node<DataType>*>* path, const CoversFunction& covers)
+{
+    assert(!path->empty());
+    auto n_common = path->size();
+    while (n_common > 0 && !covers((*path)[n_common - 1]->data()))
+        --n_common;
+    if (n_common == 0)
+        return nullptr;
+    path->resize(n_common);
+    while (path->back()->hasChildren()) {
+        const auto& children = *path->back();
+        const auto child = std::find_if(children.begin(), children.end(), [&](const auto& c) { return covers(c->data()); });
+        if (child == children.end())
+            break;
+        path->push_back(child->get());
+    }
+    return path->back();
+}
+
+// The path from root to the deepest node that covers a target (e.g., a tile, or a point), i.e., covers(node.data())
+// is true for all returned nodes. Empty if root doesn't cover the target.
+template <typename DataType, typename CoversFunction>
+std::vector<const Node<DataType>*> pathTo(const Node<DataType>& root, const CoversFunction& covers)
+{
+    std::vector<const Node<DataType>*> path;
+    if (!covers(root.data()))
+        return path;
+    path.push_back(&root);
+    moveTo(&path, covers);
+    return path;
+}
+
 template <typename DataType>
 void Node<DataType>::addChildren(const std::array<DataType, 4>& data)
 {
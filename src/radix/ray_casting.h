@@ -0,0 +1,103 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "TileHeights.h"
+#include "generator.h"
+#include "geometry.h"
+#include "tile.h"
+
+namespace radix {
+
+struct TileRayHit {
+    tile::Id id;
+    double t_entry; // ray parameter where the ray enters the tile's bounding box
+    double t_exit;
+};
+
+// Casts a ray against the terrain's bounding volume hierarchy, i.e., the tile quad tree with boxes made of the tile's
+// srs bounds and the height range from TileHeights. Yields the tiles at max_zoom_level whose boxes are hit, ordered by
+// t_entry (front to back, a best first search on a heap). Subtrees whose box is missed are skipped without visiting
+// them. The caller can stop iterating as soon as the actual geometry of a candidate tile was hit, and if there is none,
+// [t_entry of the first, t_exit of the last candidate] is the interval along the ray, in which the terrain can be.
+//
+// The ray must be given in the same coordinate system as srs_bounds(tile::Id) -> tile::SrsBounds, with heights as z
+// (e.g., web mercator and metres). The order is exact if the boxes of children are contained in the box of their
+// parent, which is the case for TileHeights generated from the data.
+//
+// heights is only read while iterating, so it is taken by pointer and must outlive the generator. The other arguments
+// are taken by value, as for onTheFlyTraverseLazy.
+//
+// usage (picking):
+//     for (const auto& hit : radix::ray_cast(&heights, ray, srs_bounds, 16)) {
+//         if (auto t = intersect_mesh(hit.id, ray)) return t;
+//     }
+template <typename SrsBoundsFunction>
+generator<TileRayHit> ray_cast(const TileHeights* heights, geometry::Line<3, double> ray, SrsBoundsFunction srs_bounds, unsigned max_zoom_level,
+    tile::Id root = { 0, { 0, 0 } })
+{
+    const auto box = [&](const tile::Id& id) {
+        const tile::SrsBounds bounds = srs_bounds(id);
+        const auto [min_height, max_height] = heights->query(id);
+        return geometry::Aabb<3, double> { glm::dvec3(bounds.min, min_height), glm::dvec3(bounds.max, max_height) };
+    };
+    const auto closer = [](const TileRayHit& a, const TileRayHit& b) { return a.t_entry > b.t_entry; };
+    std::priority_queue<TileRayHit, std::vector<TileRayHit>, decltype(closer)> queue(closer);
+
+    if (const auto interval = geometry::ray_intersection(ray, box(root)))
+        queue.push({ root, interval->first, interval->second });
+
+    while (!queue.empty()) {
+        const auto hit = queue.top();
+        queue.pop();
+        if (hit.id.zoom_level >= max_zoom_level) {
+            co_yield hit;
+            continue;
+        }
+        for (const auto& child : hit.id.children()) {
+            if (const auto interval = geometry::ray_intersection(ray, box(child)))
+                queue.push({ child, interval->first, interval->second });
+        }
+    }
+}
+
+/// parameter interval along the ray, in which the terrain can be (from the first entry to the last exit of the hit boxes
+/// at max_zoom_level).
+/// returns nothing if the ray misses the terrain's bounding volume at that level.
+template <typename SrsBoundsFunction>
+std::optional<std::pair<double, double>> ray_cast_interval(const TileHeights& heights, const geometry::Line<3, double>& ray, SrsBoundsFunction srs_bounds,
+    unsigned max_zoom_level, tile::Id root = { 0, { 0, 0 } })
+{
+    std::optional<std::pair<double, double>> interval;
+    for (const auto& hit : ray_cast(&heights, ray, srs_bounds, max_zoom_level, root)) {
+        if (!interval)
+            interval = { hit.t_entry, hit.t_exit };
+        interval->first = std::min(interval->first, hit.t_entry);
+        interval->second = std::max(interval->second, hit.t_exit);
+    }
+    return interval;
+}
+
+} // namespace radix
@@ -0,0 +1,504 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RADIX_SIMD_SSE2 1
+#include <immintrin.h>
+#endif
+#if defined(__AVX__)
+#define RADIX_SIMD_AVX 1
+#endif
+#if defined(__AVX2__)
+#define RADIX_SIMD_AVX2 1
+#endif
+
+// Thin wrappers around SSE2 / AVX registers, so that kernels can be written once (as templates over the batch type)
+// and instantiated for the native width and a scalar fallback (used for remainders and on other architectures).
+// Only what's needed by radix is implemented. The instruction set is chosen at compile time (see ALP_ENABLE_AVX2).
+//
+// min and max follow the SSE semantics: min(a, b) = a < b ? a : b, i.e., b is returned if any of them is NaN.
+// store_truncated converts to int32 (rounding towards zero), the values must be in the int32 range.
+//
+// ldexp and frexp are only implemented for double batches and the documented ranges (no denormals, infinities or
+// NaNs). They are the building blocks of the elementary functions at the end of this file.
+//
+// UIntBatch (32 bit unsigned lanes) only has the wrapping arithmetic and bit operations used on tile coordinates, and
+// pow2(n) = 2^n for n in [0, 31]. It is 256 bit wide only with AVX2.
+
+namespace radix::simd {
+
+template <typename T>
+struct Scalar {
+    using value_type = T;
+    struct Mask {
+        bool v;
+        static Mask none() { return { false }; }
+        friend Mask operator&(Mask a, Mask b) { return { a.v && b.v }; }
+        friend Mask operator|(Mask a, Mask b) { return { a.v || b.v }; }
+        friend Mask operator!(Mask a) { return { !a.v }; }
+    };
+    static constexpr size_t width = 1;
+    T v;
+
+    static Scalar load(const T* p) { return { *p }; }
+    static Scalar broadcast(T value) { return { value }; }
+    void store(T* p) const { *p = v; }
+    void store_truncated(int32_t* p) const { *p = int32_t(v); }
+
+    friend Scalar operator+(Scalar a, Scalar b) { return { a.v + b.v }; }
+    friend Scalar operator-(Scalar a, Scalar b) { return { a.v - b.v }; }
+    friend Scalar operator*(Scalar a, Scalar b) { return { a.v * b.v }; }
+    friend Scalar operator/(Scalar a, Scalar b) { return { a.v / b.v }; }
+    friend Mask operator<(Scalar a, Scalar b) { return { a.v < b.v }; }
+    friend Mask operator<=(Scalar a, Scalar b) { return { a.v <= b.v }; }
+    friend Mask operator>(Scalar a, Scalar b) { return { a.v > b.v }; }
+    friend Mask operator>=(Scalar a, Scalar b) { return { a.v >= b.v }; }
+    friend Scalar min(Scalar a, Scalar b) { return { a.v < b.v ? a.v : b.v }; }
+    friend Scalar max(Scalar a, Scalar b) { return { a.v > b.v ? a.v : b.v }; }
+    friend Scalar sqrt(Scalar a) { return { std::sqrt(a.v) }; }
+    friend Scalar operator&(Scalar a, Scalar b) { return { a.v & b.v }; }
+    friend Scalar operator|(Scalar a, Scalar b) { return { a.v | b.v }; }
+    friend Scalar operator^(Scalar a, Scalar b) { return { a.v ^ b.v }; }
+    friend Scalar pow2(Scalar n) { return { T(1) << n.v }; }
+    friend Scalar select(Mask m, Scalar a, Scalar b) { return { m.v ? a.v : b.v }; }
+    friend unsigned bits(Mask m) { return unsigned(m.v); }
+    friend Scalar ldexp(Scalar a, Scalar n) { return { std::ldexp(a.v, int(n.v)) }; }
+    friend Scalar frexp(Scalar a, Scalar* exponent)
+    {
+        int e = 0;
+        const auto mantissa = std::frexp(a.v, &e);
+        *exponent = { T(e) };
+        return { mantissa };
+    }
+};
+
+#if defined(RADIX_SIMD_SSE2)
+namespace detail {
+    // 2^n for integral n in [-1022, 1023]: n + 1023 is added to 2^52, where it ends up in the low mantissa bits, and
+    // shifted into the exponent.
+    inline __m128d pow2(__m128d n)
+    {
+        const auto biased = _mm_castpd_si128(_mm_add_pd(n, _mm_set1_pd(4503599627370496.0 + 1023)));
+        return _mm_castsi128_pd(_mm_slli_epi64(biased, 52));
+    }
+
+    // mantissa in [0.5, 1) (with the sign of a) and exponent of finite, normal, non zero a. the exponent bits are
+    // placed in the low mantissa bits of 2^52 to convert them to double.
+    inline __m128d frexp(__m128d a, __m128d* exponent)
+    {
+        const auto bits = _mm_castpd_si128(a);
+        const auto biased = _mm_and_si128(_mm_srli_epi64(bits, 52), _mm_set1_epi64x(0x7ff));
+        *exponent = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(biased, _mm_castpd_si128(_mm_set1_pd(4503599627370496.0)))), _mm_set1_pd(4503599627370496.0 + 1022));
+        const auto mantissa = _mm_and_si128(bits, _mm_set1_epi64x(int64_t(0x800F'FFFF'FFFF'FFFFull)));
+        return _mm_castsi128_pd(_mm_or_si128(mantissa, _mm_castpd_si128(_mm_set1_pd(0.5))));
+    }
+} // namespace detail
+#endif
+
+#if defined(RADIX_SIMD_AVX)
+struct FloatBatch {
+    using value_type = float;
+    struct Mask {
+        __m256 v;
+        static Mask none() { return { _mm256_setzero_ps() }; }
+        friend Mask operator&(Mask a, Mask b) { return { _mm256_and_ps(a.v, b.v) }; }
+        friend Mask operator|(Mask a, Mask b) { return { _mm256_or_ps(a.v, b.v) }; }
+        friend Mask operator!(Mask a) { return { _mm256_xor_ps(a.v, _mm256_castsi256_ps(_mm256_set1_epi32(-1))) }; }
+    };
+    static constexpr size_t width = 8;
+    __m256 v;
+
+    static FloatBatch load(const float* p) { return { _mm256_loadu_ps(p) }; }
+    static FloatBatch broadcast(float value) { return { _mm256_set1_ps(value) }; }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+    void store_truncated(int32_t* p) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm256_cvttps_epi32(v)); }
+
+    friend FloatBatch operator+(FloatBatch a, FloatBatch b) { return { _mm256_add_ps(a.v, b.v) }; }
+    friend FloatBatch operator-(FloatBatch a, FloatBatch b) { return { _mm256_sub_ps(a.v, b.v) }; }
+    friend FloatBatch operator*(FloatBatch a, FloatBatch b) { return { _mm256_mul_ps(a.v, b.v) }; }
+    friend FloatBatch operator/(FloatBatch a, FloatBatch b) { return { _mm256_div_ps(a.v, b.v) }; }
+    friend Mask operator<(FloatBatch a, FloatBatch b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+    friend Mask operator<=(FloatBatch a, FloatBatch b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+    friend Mask operator>(FloatBatch a, FloatBatch b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+    friend Mask operator>=(FloatBatch a, FloatBatch b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+    friend FloatBatch min(FloatBatch a, FloatBatch b) { return { _mm256_min_ps(a.v, b.v) }; }
+    friend FloatBatch max(FloatBatch a, FloatBatch b) { return { _mm256_max_ps(a.v, b.v) }; }
+    friend FloatBatch sqrt(FloatBatch a) { return { _mm256_sqrt_ps(a.v) }; }
+    friend FloatBatch select(Mask m, FloatBatch a, FloatBatch b) { return { _mm256_blendv_ps(b.v, a.v, m.v) }; }
+    friend unsigned bits(Mask m) { return unsigned(_mm256_movemask_ps(m.v)); }
+};
+
+struct DoubleBatch {
+    using value_type = double;
+    struct Mask {
+        __m256d v;
+        static Mask none() { return { _mm256_setzero_pd() }; }
+        friend Mask operator&(Mask a, Mask b) { return { _mm256_and_pd(a.v, b.v) }; }
+        friend Mask operator|(Mask a, Mask b) { return { _mm256_or_pd(a.v, b.v) }; }
+        friend Mask operator!(Mask a) { return { _mm256_xor_pd(a.v, _mm256_castsi256_pd(_mm256_set1_epi32(-1))) }; }
+    };
+    static constexpr size_t width = 4;
+    __m256d v;
+
+    static DoubleBatch load(const double* p) { return { _mm256_loadu_pd(p) }; }
+    static DoubleBatch broadcast(double value) { return { _mm256_set1_pd(value) }; }
+    void store(double* p) const { _mm256_storeu_pd(p, v); }
+    void store_truncated(int32_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_cvttpd_epi32(v)); }
+
+    friend DoubleBatch operator+(DoubleBatch a, DoubleBatch b) { return { _mm256_add_pd(a.v, b.v) }; }
+    friend DoubleBatch operator-(DoubleBatch a, DoubleBatch b) { return { _mm256_sub_pd(a.v, b.v) }; }
+    friend DoubleBatch operator*(DoubleBatch a, DoubleBatch b) { return { _mm256_mul_pd(a.v, b.v) }; }
+    friend DoubleBatch operator/(DoubleBatch a, DoubleBatch b) { return { _mm256_div_pd(a.v, b.v) }; }
+    friend Mask operator<(DoubleBatch a, DoubleBatch b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ) }; }
+    friend Mask operator<=(DoubleBatch a, DoubleBatch b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ) }; }
+    friend Mask operator>(DoubleBatch a, DoubleBatch b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ) }; }
+    friend Mask operator>=(DoubleBatch a, DoubleBatch b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ) }; }
+    friend DoubleBatch min(DoubleBatch a, DoubleBatch b) { return { _mm256_min_pd(a.v, b.v) }; }
+    friend DoubleBatch max(DoubleBatch a, DoubleBatch b) { return { _mm256_max_pd(a.v, b.v) }; }
+    friend DoubleBatch sqrt(DoubleBatch a) { return { _mm256_sqrt_pd(a.v) }; }
+    friend DoubleBatch select(Mask m, DoubleBatch a, DoubleBatch b) { return { _mm256_blendv_pd(b.v, a.v, m.v) }; }
+    friend unsigned bits(Mask m) { return unsigned(_mm256_movemask_pd(m.v)); }
+    // the integer shifts are done on the two halves, 256 bit versions need AVX2
+    friend DoubleBatch ldexp(DoubleBatch a, DoubleBatch n)
+    {
+        const auto low = detail::pow2(_mm256_castpd256_pd128(n.v));
+        const auto high = detail::pow2(_mm256_extractf128_pd(n.v, 1));
+        return { _mm256_mul_pd(a.v, _mm256_insertf128_pd(_mm256_castpd128_pd256(low), high, 1)) };
+    }
+    friend DoubleBatch frexp(DoubleBatch a, DoubleBatch* exponent)
+    {
+        __m128d exponent_low;
+        __m128d exponent_high;
+        const auto low = detail::frexp(_mm256_castpd256_pd128(a.v), &exponent_low);
+        const auto high = detail::frexp(_mm256_extractf128_pd(a.v, 1), &exponent_high);
+        exponent->v = _mm256_insertf128_pd(_mm256_castpd128_pd256(exponent_low), exponent_high, 1);
+        return { _mm256_insertf128_pd(_mm256_castpd128_pd256(low), high, 1) };
+    }
+};
+#elif defined(RADIX_SIMD_SSE2)
+struct FloatBatch {
+    using value_type = float;
+    struct Mask {
+        __m128 v;
+        static Mask none() { return { _mm_setzero_ps() }; }
+        friend Mask operator&(Mask a, Mask b) { return { _mm_and_ps(a.v, b.v) }; }
+        friend Mask operator|(Mask a, Mask b) { return { _mm_or_ps(a.v, b.v) }; }
+        friend Mask operator!(Mask a) { return { _mm_xor_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(-1))) }; }
+    };
+    static constexpr size_t width = 4;
+    __m128 v;
+
+    static FloatBatch load(const float* p) { return { _mm_loadu_ps(p) }; }
+    static FloatBatch broadcast(float value) { return { _mm_set1_ps(value) }; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    void store_truncated(int32_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_cvttps_epi32(v)); }
+
+    friend FloatBatch operator+(FloatBatch a, FloatBatch b) { return { _mm_add_ps(a.v, b.v) }; }
+    friend FloatBatch operator-(FloatBatch a, FloatBatch b) { return { _mm_sub_ps(a.v, b.v) }; }
+    friend FloatBatch operator*(FloatBatch a, FloatBatch b) { return { _mm_mul_ps(a.v, b.v) }; }
+    friend FloatBatch operator/(FloatBatch a, FloatBatch b) { return { _mm_div_ps(a.v, b.v) }; }
+    friend Mask operator<(FloatBatch a, FloatBatch b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+    friend Mask operator<=(FloatBatch a, FloatBatch b) { return { _mm_cmple_ps(a.v, b.v) }; }
+    friend Mask operator>(FloatBatch a, FloatBatch b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+    friend Mask operator>=(FloatBatch a, FloatBatch b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+    friend FloatBatch min(FloatBatch a, FloatBatch b) { return { _mm_min_ps(a.v, b.v) }; }
+    friend FloatBatch max(FloatBatch a, FloatBatch b) { return { _mm_max_ps(a.v, b.v) }; }
+    friend FloatBatch sqrt(FloatBatch a) { return { _mm_sqrt_ps(a.v) }; }
+    friend FloatBatch select(Mask m, FloatBatch a, FloatBatch b) { return { _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)) }; }
+    friend unsigned bits(Mask m) { return unsigned(_mm_movemask_ps(m.v)); }
+};
+
+struct DoubleBatch {
+    using value_type = double;
+    struct Mask {
+        __m128d v;
+        static Mask none() { return { _mm_setzero_pd() }; }
+        friend Mask operator&(Mask a, Mask b) { return { _mm_and_pd(a.v, b.v) }; }
+        friend Mask operator|(Mask a, Mask b) { return { _mm_or_pd(a.v, b.v) }; }
+        friend Mask operator!(Mask a) { return { _mm_xor_pd(a.v, _mm_castsi128_pd(_mm_set1_epi32(-1))) }; }
+    };
+    static constexpr size_t width = 2;
+    __m128d v;
+
+    static DoubleBatch load(const double* p) { return { _mm_loadu_pd(p) }; }
+    static DoubleBatch broadcast(double value) { return { _mm_set1_pd(value) }; }
+    void store(double* p) const { _mm_storeu_pd(p, v); }
+    void store_truncated(int32_t* p) const { _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_cvttpd_epi32(v)); }
+
+    friend DoubleBatch operator+(DoubleBatch a, DoubleBatch b) { return { _mm_add_pd(a.v, b.v) }; }
+    friend DoubleBatch operator-(DoubleBatch a, DoubleBatch b) { return { _mm_sub_pd(a.v, b.v) }; }
+    friend DoubleBatch operator*(DoubleBatch a, DoubleBatch b) { return { _mm_mul_pd(a.v, b.v) }; }
+    friend DoubleBatch operator/(DoubleBatch a, DoubleBatch b) { return { _mm_div_pd(a.v, b.v) }; }
+    friend Mask operator<(DoubleBatch a, DoubleBatch b) { return { _mm_cmplt_pd(a.v, b.v) }; }
+    friend Mask operator<=(DoubleBatch a, DoubleBatch b) { return { _mm_cmple_pd(a.v, b.v) }; }
+    friend Mask operator>(DoubleBatch a, DoubleBatch b) { return { _mm_cmpgt_pd(a.v, b.v) }; }
+    friend Mask operator>=(DoubleBatch a, DoubleBatch b) { return { _mm_cmpge_pd(a.v, b.v) }; }
+    friend DoubleBatch min(DoubleBatch a, DoubleBatch b) { return { _mm_min_pd(a.v, b.v) }; }
+    friend DoubleBatch max(DoubleBatch a, DoubleBatch b) { return { _mm_max_pd(a.v, b.v) }; }
+    friend DoubleBatch sqrt(DoubleBatch a) { return { _mm_sqrt_pd(a.v) }; }
+    friend DoubleBatch select(Mask m, DoubleBatch a, DoubleBatch b) { return { _mm_or_pd(_mm_and_pd(m.v, a.v), _mm_andnot_pd(m.v, b.v)) }; }
+    friend unsigned bits(Mask m) { return unsigned(_mm_movemask_pd(m.v)); }
+    friend DoubleBatch ldexp(DoubleBatch a, DoubleBatch n) { return { _mm_mul_pd(a.v, detail::pow2(n.v)) }; }
+    friend DoubleBatch frexp(DoubleBatch a, DoubleBatch* exponent) { return { detail::frexp(a.v, &exponent->v) }; }
+};
+#endif
+
+#if defined(RADIX_SIMD_AVX2)
+struct UIntBatch {
+    using value_type = unsigned;
+    static constexpr size_t width = 8;
+    __m256i v;
+
+    static UIntBatch load(const unsigned* p) { return { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)) }; }
+    static UIntBatch broadcast(unsigned value) { return { _mm256_set1_epi32(int(value)) }; }
+    void store(unsigned* p) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+
+    friend UIntBatch operator+(UIntBatch a, UIntBatch b) { return { _mm256_add_epi32(a.v, b.v) }; }
+    friend UIntBatch operator-(UIntBatch a, UIntBatch b) { return { _mm256_sub_epi32(a.v, b.v) }; }
+    friend UIntBatch operator&(UIntBatch a, UIntBatch b) { return { _mm256_and_si256(a.v, b.v) }; }
+    friend UIntBatch operator|(UIntBatch a, UIntBatch b) { return { _mm256_or_si256(a.v, b.v) }; }
+    friend UIntBatch operator^(UIntBatch a, UIntBatch b) { return { _mm256_xor_si256(a.v, b.v) }; }
+    friend UIntBatch pow2(UIntBatch n) { return { _mm256_sllv_epi32(_mm256_set1_epi32(1), n.v) }; }
+};
+#elif defined(RADIX_SIMD_SSE2)
+struct UIntBatch {
+    using value_type = unsigned;
+    static constexpr size_t width = 4;
+    __m128i v;
+
+    static UIntBatch load(const unsigned* p) { return { _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)) }; }
+    static UIntBatch broadcast(unsigned value) { return { _mm_set1_epi32(int(value)) }; }
+    void store(unsigned* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+    friend UIntBatch operator+(UIntBatch a, UIntBatch b) { return { _mm_add_epi32(a.v, b.v) }; }
+    friend UIntBatch operator-(UIntBatch a, UIntBatch b) { return { _mm_sub_epi32(a.v, b.v) }; }
+    friend UIntBatch operator&(UIntBatch a, UIntBatch b) { return { _mm_and_si128(a.v, b.v) }; }
+    friend UIntBatch operator|(UIntBatch a, UIntBatch b) { return { _mm_or_si128(a.v, b.v) }; }
+    friend UIntBatch operator^(UIntBatch a, UIntBatch b) { return { _mm_xor_si128(a.v, b.v) }; }
+    // SSE2 has no per lane shifts. n + 127 shifted into the exponent is the float 2^n, which is converted back. 2^31 is
+    // out of the int32 range, the conversion returns 0x80000000 for it, which is 2^31 as unsigned.
+    friend UIntBatch pow2(UIntBatch n)
+    {
+        const auto exponent = _mm_slli_epi32(_mm_add_epi32(n.v, _mm_set1_epi32(127)), 23);
+        return { _mm_cvttps_epi32(_mm_castsi128_ps(exponent)) };
+    }
+};
+#endif
+
+namespace detail {
+    template <typename T>
+    struct Native {
+        using type = Scalar<T>;
+    };
+#if defined(RADIX_SIMD_SSE2)
+    template <>
+    struct Native<float> {
+        using type = FloatBatch;
+    };
+    template <>
+    struct Native<double> {
+        using type = DoubleBatch;
+    };
+    template <>
+    struct Native<unsigned> {
+        using type = UIntBatch;
+    };
+#endif
+} // namespace detail
+
+/// widest batch type available for T (Scalar<T> if there is no simd support)
+template <typename T>
+using Batch = typename detail::Native<T>::type;
+
+// Elementary functions for DoubleBatch and Scalar<double>, used by the srs projections. Range reduction (with split
+// constants) followed by truncated Taylor series with exact coefficients. The error is a few ulp on the documented
+// domains (checked against std:: in unittests/simd.cpp), there is no special handling of NaNs and infinities.
+namespace detail {
+    template <typename Batch>
+    constexpr bool is_double_batch = std::is_same_v<typename Batch::value_type, double>;
+
+    // round to nearest (ties to even) for |x| < 2^51
+    template <typename Batch>
+    Batch round(Batch x)
+    {
+        const auto magic = Batch::broadcast(6755399441055744.0); // 1.5 * 2^52
+        return (x + magic) - magic;
+    }
+
+    // coefficients[0] + x * (coefficients[1] + x * (...))
+    template <typename Batch, size_t n>
+    Batch polynomial(Batch x, const std::array<double, n>& coefficients)
+    {
+        auto result = Batch::broadcast(coefficients[n - 1]);
+        for (size_t i = n - 1; i > 0; --i)
+            result = result * x + Batch::broadcast(coefficients[i - 1]);
+        return result;
+    }
+
+    // 1/k!, for exp on [-ln(2) / 2, ln(2) / 2], the first omitted term is < 1e-17
+    constexpr auto exp_series = []() {
+        std::array<double, 14> c {};
+        double factorial = 1;
+        for (size_t k = 0; k < c.size(); ++k) {
+            factorial *= k == 0 ? 1 : double(k);
+            c[k] = 1 / factorial;
+        }
+        return c;
+    }();
+
+    // 1 / (2k + 1), for atanh(s) / s with s^2 < 0.03
+    constexpr auto atanh_series = []() {
+        std::array<double, 12> c {};
+        for (size_t k = 0; k < c.size(); ++k)
+            c[k] = 1 / double(2 * k + 1);
+        return c;
+    }();
+
+    // (-1)^k / (2k + 1), for atan(t) / t with |t| <= tan(pi / 8)
+    constexpr auto atan_series = []() {
+        std::array<double, 22> c {};
+        for (size_t k = 0; k < c.size(); ++k)
+            c[k] = (k % 2 ? -1 : 1) / double(2 * k + 1);
+        return c;
+    }();
+
+    // (-1)^k / (2k + 1)!, for sin(r) / r with |r| <= pi / 2
+    constexpr auto sin_series = []() {
+        std::array<double, 12> c {};
+        double factorial = 1;
+        for (size_t k = 0; k < c.size(); ++k) {
+            factorial *= k == 0 ? 1 : double(2 * k) * double(2 * k + 1);
+            c[k] = (k % 2 ? -1 : 1) / factorial;
+        }
+        return c;
+    }();
+
+    // n - 2 round(n / 2) is -1, 0 or 1 for integral n
+    template <typename Batch>
+    typename Batch::Mask is_odd(Batch n)
+    {
+        const auto half = Batch::broadcast(0.5);
+        const auto parity = n - round(n * half) * Batch::broadcast(2);
+        return (parity > half) | (parity < Batch::broadcast(-0.5));
+    }
+
+    constexpr double ln2_high = 0.693145751953125; // 16 significant bits, n * ln2_high is exact
+    constexpr double ln2_low = 1.4286068203094173e-06;
+    constexpr double pi_high = 3.1415926553308964; // 30 significant bits
+    constexpr double pi_low = -1.7411031391008332e-09;
+} // namespace detail
+
+/// |x| < 708 (the result is a normal number)
+template <typename Batch>
+    requires detail::is_double_batch<Batch>
+Batch exp(Batch x)
+{
+    const auto n = detail::round(x * Batch::broadcast(1.4426950408889634));
+    const auto r = (x - n * Batch::broadcast(detail::ln2_high)) - n * Batch::broadcast(detail::ln2_low);
+    return ldexp(detail::polynomial(r, detail::exp_series), n);
+}
+
+/// x > 0, finite and normal. log(m * 2^e) = e * ln(2) + 2 atanh((m - 1) / (m + 1)), with m in [sqrt(0.5), sqrt(2)).
+template <typename Batch>
+    requires detail::is_double_batch<Batch>
+Batch log(Batch x)
+{
+    auto e = Batch::broadcast(0);
+    auto m = frexp(x, &e);
+    const auto small = m < Batch::broadcast(0.7071067811865476);
+    m = select(small, m + m, m);
+    e = select(small, e - Batch::broadcast(1), e);
+    const auto f = m - Batch::broadcast(1); // exact
+    const auto s = f / (Batch::broadcast(2) + f);
+    const auto log_m = (s + s) * detail::polynomial(s * s, detail::atanh_series);
+    return e * Batch::broadcast(detail::ln2_high) + (e * Batch::broadcast(detail::ln2_low) + log_m);
+}
+
+/// any finite x. the argument is reduced to [-pi / 4, pi / 4] (plus offsets of pi / 2 or pi / 4, as in cephes).
+template <typename Batch>
+    requires detail::is_double_batch<Batch>
+Batch atan(Batch x)
+{
+    const auto zero = Batch::broadcast(0);
+    const auto one = Batch::broadcast(1);
+    const auto negative = x < zero;
+    const auto a = select(negative, zero - x, x);
+    const auto big = a > Batch::broadcast(2.414213562373095); // tan(3 pi / 8)
+    const auto mid = a > Batch::broadcast(0.41421356237309503); // tan(pi / 8)
+    const auto t = select(big, zero - one / a, select(mid, (a - one) / (a + one), a));
+    const auto offset = select(big, Batch::broadcast(1.5707963267948966), select(mid, Batch::broadcast(0.7853981633974483), zero));
+    // the parts of pi / 2 and pi / 4 that are lost in the offsets
+    const auto correction = select(big, Batch::broadcast(6.123233995736766e-17), select(mid, Batch::broadcast(3.061616997868383e-17), zero));
+    const auto result = offset + (t * detail::polynomial(t * t, detail::atan_series) + correction);
+    return select(negative, zero - result, result);
+}
+
+/// any finite y and x, atan2(0, 0) = 0 (signed zeros are not distinguished). min(|y|, |x|) / max(|y|, |x|) is in
+/// [0, 1], its atan is mirrored into the right octant.
+template <typename Batch>
+    requires detail::is_double_batch<Batch>
+Batch atan2(Batch y, Batch x)
+{
+    const auto zero = Batch::broadcast(0);
+    const auto abs_y = select(y < zero, zero - y, y);
+    const auto abs_x = select(x < zero, zero - x, x);
+    const auto steep = abs_y > abs_x;
+    const auto numerator = min(abs_y, abs_x);
+    const auto denominator = max(abs_y, abs_x);
+    const auto t = select(denominator > zero, numerator / denominator, zero);
+    auto result = atan(t);
+    // pi / 2 - result and pi - result, with the parts of pi lost in the constants
+    result = select(steep, (Batch::broadcast(1.5707963267948966) - result) + Batch::broadcast(6.123233995736766e-17), result);
+    result = select(x < zero, (Batch::broadcast(3.141592653589793) - result) + Batch::broadcast(1.2246467991473532e-16), result);
+    return select(y < zero, zero - result, result);
+}
+
+/// |x| < 1e6. x - n pi is computed with a split pi, odd n flip the sign.
+template <typename Batch>
+    requires detail::is_double_batch<Batch>
+Batch sin(Batch x)
+{
+    const auto n = detail::round(x * Batch::broadcast(0.3183098861837907)); // 1 / pi
+    const auto r = (x - n * Batch::broadcast(detail::pi_high)) - n * Batch::broadcast(detail::pi_low);
+    const auto result = r * detail::polynomial(r * r, detail::sin_series);
+    return select(detail::is_odd(n), Batch::broadcast(0) - result, result);
+}
+
+/// |x| < 1e6. reduced to r = x - (n + 1/2) pi, so that the result is accurate close to the zeros as well:
+/// cos(x) = -(-1)^n sin(r)
+template <typename Batch>
+    requires detail::is_double_batch<Batch>
+Batch cos(Batch x)
+{
+    const auto half = Batch::broadcast(0.5);
+    const auto n = detail::round(x * Batch::broadcast(0.3183098861837907) - half);
+    const auto m = n + half; // n * pi_high and m * pi_high are exact
+    const auto r = (x - m * Batch::broadcast(detail::pi_high)) - m * Batch::broadcast(detail::pi_low);
+    const auto result = r * detail::polynomial(r * r, detail::sin_series);
+    return select(detail::is_odd(n), result, Batch::broadcast(0) - result);
+}
+
+} // namespace radix::simd
@@ -0,0 +1,193 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <barrier>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "morton.h"
+#include "tile.h"
+
+// Stable LSD radix sort of 64 bit keys (optionally with a payload), and packed keys for tile ids.
+
+namespace radix {
+
+namespace detail {
+    // 8 bits per pass, passes over digits that are equal for all keys are skipped (so clustered keys, e.g., tiles of
+    // a region, need few passes). every thread counts and scatters its own part of the array, the parts are
+    // synchronised with a barrier after each phase, so the order within a bucket is preserved.
+    template <bool with_values, typename Value>
+    void lsd_radix_sort(std::span<uint64_t> keys, std::span<Value> values, unsigned n_threads)
+    {
+        const auto n = keys.size();
+        if (n < 2)
+            return;
+        n_threads = std::max(1u, std::min<unsigned>(n_threads, unsigned(n / 65536 + 1)));
+
+        uint64_t any_bits = 0;
+        uint64_t all_bits = ~uint64_t(0);
+        for (const auto key : keys) {
+            any_bits |= key;
+            all_bits &= key;
+        }
+        std::vector<unsigned> shifts;
+        for (unsigned shift = 0; shift < 64; shift += 8) {
+            if (((any_bits ^ all_bits) >> shift) & 0xFF)
+                shifts.push_back(shift);
+        }
+        if (shifts.empty())
+            return;
+
+        std::vector<uint64_t> key_buffer(n);
+        std::vector<Value> value_buffer(with_values ? n : 0);
+        std::vector<std::array<size_t, 256>> counts(n_threads);
+        unsigned phase = 0;
+        const auto completion = [&]() noexcept {
+            // after counting: turn the counts into the first output position of each (bucket, thread)
+            if (phase++ % 2)
+                return;
+            size_t offset = 0;
+            for (unsigned bucket = 0; bucket < 256; ++bucket) {
+                for (auto& count : counts) {
+                    const auto c = count[bucket];
+                    count[bucket] = offset;
+                    offset += c;
+                }
+            }
+        };
+        std::barrier barrier(std::ptrdiff_t(n_threads), completion);
+
+        const auto work = [&](unsigned thread) {
+            const auto begin = n * thread / n_threads;
+            const auto end = n * (thread + 1) / n_threads;
+            auto& count = counts[thread];
+            for (size_t pass = 0; pass < shifts.size(); ++pass) {
+                const auto shift = shifts[pass];
+                const uint64_t* src_keys = pass % 2 ? key_buffer.data() : keys.data();
+                uint64_t* dst_keys = pass % 2 ? keys.data() : key_buffer.data();
+                count.fill(0);
+                for (size_t i = begin; i < end; ++i)
+                    ++count[(src_keys[i] >> shift) & 0xFF];
+                barrier.arrive_and_wait();
+                if constexpr (with_values) {
+                    const Value* src_values = pass % 2 ? value_buffer.data() : values.data();
+                    Value* dst_values = pass % 2 ? values.data() : value_buffer.data();
+                    for (size_t i = begin; i < end; ++i) {
+                        const auto pos = count[(src_keys[i] >> shift) & 0xFF]++;
+                        dst_keys[pos] = src_keys[i];
+                        dst_values[pos] = src_values[i];
+                    }
+                } else {
+                    for (size_t i = begin; i < end; ++i)
+                        dst_keys[count[(src_keys[i] >> shift) & 0xFF]++] = src_keys[i];
+                }
+                barrier.arrive_and_wait();
+            }
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(n_threads - 1);
+        for (unsigned i = 1; i < n_threads; ++i)
+            threads.emplace_back(work, i);
+        work(0);
+        for (auto& thread : threads)
+            thread.join();
+
+        if (shifts.size() % 2) {
+            std::copy(key_buffer.begin(), key_buffer.end(), keys.begin());
+            if constexpr (with_values)
+                std::copy(value_buffer.begin(), value_buffer.end(), values.begin());
+        }
+    }
+} // namespace detail
+
+/// stable sort of keys. n_threads is an upper bound, small inputs use fewer threads.
+inline void radix_sort(std::span<uint64_t> keys, unsigned n_threads = 1)
+{
+    detail::lsd_radix_sort<false>(keys, std::span<char>(), n_threads);
+}
+
+/// stable sort of keys, values are permuted along. Value must be default constructible and copyable.
+template <typename Value>
+void radix_sort(std::span<uint64_t> keys, std::span<Value> values, unsigned n_threads = 1)
+{
+    assert(keys.size() == values.size());
+    detail::lsd_radix_sort<true>(keys, values, n_threads);
+}
+
+namespace tile {
+
+    enum class KeyOrder {
+        ZoomMajor, // zoom level, x, y; the same order as Id::operator<
+        Morton, // zoom level, Morton code of the coordinates
+        QuadTree // depth first (pre-order) traversal of the quad tree in Morton order, parents come before their children
+    };
+
+    constexpr unsigned max_key_zoom_level = 29;
+
+    /// packs zoom level (6 bits) and coordinates (29 bits each) into 64 bits, so zoom levels up to 29 are supported.
+    /// the scheme is not stored.
+    inline uint64_t to_key(const Id& id, KeyOrder order)
+    {
+        assert(id.zoom_level <= max_key_zoom_level);
+        if (order == KeyOrder::QuadTree) // the Morton code extended to max_key_zoom_level, zoom level in the low bits
+            return ((morton::encode(id.coords) << (2 * (max_key_zoom_level - id.zoom_level))) << 6) | id.zoom_level;
+        const auto zoom = uint64_t(id.zoom_level) << 58;
+        if (order == KeyOrder::Morton)
+            return zoom | morton::encode(id.coords);
+        return zoom | (uint64_t(id.coords.x) << 29) | uint64_t(id.coords.y);
+    }
+
+    inline Id from_key(uint64_t key, KeyOrder order, Scheme scheme = Scheme::Tms)
+    {
+        if (order == KeyOrder::QuadTree) {
+            const auto zoom_level = unsigned(key & 0x3F);
+            return { zoom_level, morton::decode((key >> 6) >> (2 * (max_key_zoom_level - zoom_level))), scheme };
+        }
+        const auto zoom_level = unsigned(key >> 58);
+        const auto coords_bits = key & ((uint64_t(1) << 58) - 1);
+        if (order == KeyOrder::Morton)
+            return { zoom_level, morton::decode(coords_bits), scheme };
+        constexpr auto mask = (uint64_t(1) << 29) - 1;
+        return { zoom_level, { unsigned(coords_bits >> 29), unsigned(coords_bits & mask) }, scheme };
+    }
+
+    /// sorts ids with the same scheme. ZoomMajor gives the same result as std::sort.
+    inline void sort(std::span<Id> ids, KeyOrder order = KeyOrder::ZoomMajor, unsigned n_threads = 1)
+    {
+        if (ids.empty())
+            return;
+        const auto scheme = ids.front().scheme;
+        std::vector<uint64_t> keys(ids.size());
+        for (size_t i = 0; i < ids.size(); ++i) {
+            assert(ids[i].scheme == scheme);
+            keys[i] = to_key(ids[i], order);
+        }
+        radix_sort(std::span(keys), n_threads);
+        for (size_t i = 0; i < ids.size(); ++i)
+            ids[i] = from_key(keys[i], order, scheme);
+    }
+
+} // namespace tile
+} // namespace radix
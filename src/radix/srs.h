@@ -0,0 +1,351 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <span>
+
+#include <glm/glm.hpp>
+
+#include "simd.h"
+#include "tile.h"
+
+// Conversions between WGS84 latitude / longitude (degrees), web mercator (EPSG:3857, "world" coordinates in metres)
+// and earth centred, earth fixed (ECEF) cartesian coordinates, and srs bounds of tiles.
+// Coordinate order is (latitude, longitude[, altitude]) for geographic points and (x, y[, z]) for projected points.
+// Srs bounds are always (x, y), i.e., (longitude, latitude) for EPSG:4326.
+//
+// The span versions are batch kernels for the hot loops (thousands of points or tiles at once), without allocations. In
+// and out may be the same span. They are simd kernels (using the elementary functions from simd.h) with a scalar tail,
+// they agree with the scalar versions to about 1e-7 m and 1e-13 degrees.
+
+namespace radix::srs {
+
+constexpr double pi = 3.14159265358979323846;
+constexpr double earth_radius = 6378137.0; // web mercator sphere and WGS84 semi major axis
+constexpr double wgs84_flattening = 1 / 298.257223563;
+constexpr double wgs84_eccentricity_sq = wgs84_flattening * (2 - wgs84_flattening);
+constexpr double web_mercator_extent = pi * earth_radius; // the world is [-extent, extent]^2
+constexpr int epsg_web_mercator = 3857;
+constexpr int epsg_wgs84 = 4326;
+
+inline glm::dvec2 lat_long_to_world(const glm::dvec2& lat_long)
+{
+    const auto latitude = lat_long.x * pi / 180;
+    const auto x = earth_radius * lat_long.y * pi / 180;
+    const auto y = earth_radius * std::log(std::tan(pi / 4 + latitude / 2));
+    return { x, y };
+}
+
+inline glm::dvec2 world_to_lat_long(const glm::dvec2& world)
+{
+    const auto latitude = 2 * std::atan(std::exp(world.y / earth_radius)) - pi / 2;
+    return { latitude * 180 / pi, world.x / earth_radius * 180 / pi };
+}
+
+inline glm::dvec3 lat_long_alt_to_ecef(const glm::dvec3& lat_long_alt)
+{
+    const auto latitude = lat_long_alt.x * pi / 180;
+    const auto longitude = lat_long_alt.y * pi / 180;
+    const auto sin_latitude = std::sin(latitude);
+    const auto cos_latitude = std::cos(latitude);
+    // prime vertical radius of curvature
+    const auto n = earth_radius / std::sqrt(1 - wgs84_eccentricity_sq * sin_latitude * sin_latitude);
+    return { (n + lat_long_alt.z) * cos_latitude * std::cos(longitude),
+        (n + lat_long_alt.z) * cos_latitude * std::sin(longitude),
+        (n * (1 - wgs84_eccentricity_sq) + lat_long_alt.z) * sin_latitude };
+}
+
+/// Bowring's method with a fixed number of iterations (sub millimetre accuracy for terrestrial points).
+inline glm::dvec3 ecef_to_lat_long_alt(const glm::dvec3& ecef)
+{
+    const auto p = std::sqrt(ecef.x * ecef.x + ecef.y * ecef.y);
+    const auto longitude = std::atan2(ecef.y, ecef.x);
+    auto latitude = std::atan2(ecef.z, p * (1 - wgs84_eccentricity_sq));
+    for (int i = 0; i < 3; ++i) {
+        const auto sin_latitude = std::sin(latitude);
+        const auto n = earth_radius / std::sqrt(1 - wgs84_eccentricity_sq * sin_latitude * sin_latitude);
+        latitude = std::atan2(ecef.z + wgs84_eccentricity_sq * n * sin_latitude, p);
+    }
+    const auto sin_latitude = std::sin(latitude);
+    const auto cos_latitude = std::cos(latitude);
+    const auto n = earth_radius / std::sqrt(1 - wgs84_eccentricity_sq * sin_latitude * sin_latitude);
+    // the z based formula is more stable near the poles
+    const auto altitude = std::abs(cos_latitude) > 0.1 ? p / cos_latitude - n : ecef.z / sin_latitude - n * (1 - wgs84_eccentricity_sq);
+    return { latitude * 180 / pi, longitude * 180 / pi, altitude };
+}
+
+/// web mercator x, y and altitude to ECEF.
+inline glm::dvec3 world_to_ecef(const glm::dvec3& world)
+{
+    const auto lat_long = world_to_lat_long(glm::dvec2(world));
+    return lat_long_alt_to_ecef({ lat_long, world.z });
+}
+
+namespace detail {
+    // the points are de-interleaved into lanes, all lanes are read before any is written (in and out may alias).
+    // log(tan(pi / 4 + latitude / 2)) = log((1 + sin(latitude)) / cos(latitude)). it's computed for |latitude|, as
+    // 1 + sin(latitude) cancels close to the south pole.
+    template <typename Batch>
+    size_t lat_long_to_world_range(std::span<const glm::dvec2> lat_long, glm::dvec2* world)
+    {
+        constexpr auto width = Batch::width;
+        const auto n_simd = lat_long.size() - lat_long.size() % width;
+        std::array<double, width> latitudes;
+        std::array<double, width> longitudes;
+        for (size_t i = 0; i < n_simd; i += width) {
+            for (size_t l = 0; l < width; ++l) {
+                latitudes[l] = lat_long[i + l].x;
+                longitudes[l] = lat_long[i + l].y;
+            }
+            const auto zero = Batch::broadcast(0);
+            const auto latitude = Batch::load(latitudes.data()) * Batch::broadcast(pi / 180);
+            const auto south = latitude < zero;
+            const auto a = select(south, zero - latitude, latitude);
+            const auto y = simd::log((Batch::broadcast(1) + simd::sin(a)) / simd::cos(a)) * Batch::broadcast(earth_radius);
+            const auto x = Batch::broadcast(earth_radius) * Batch::load(longitudes.data()) * Batch::broadcast(pi) / Batch::broadcast(180);
+            x.store(longitudes.data());
+            select(south, zero - y, y).store(latitudes.data());
+            for (size_t l = 0; l < width; ++l)
+                world[i + l] = { longitudes[l], latitudes[l] };
+        }
+        return n_simd;
+    }
+
+    template <typename Batch>
+    size_t world_to_lat_long_range(std::span<const glm::dvec2> world, glm::dvec2* lat_long)
+    {
+        constexpr auto width = Batch::width;
+        const auto n_simd = world.size() - world.size() % width;
+        std::array<double, width> xs;
+        std::array<double, width> ys;
+        for (size_t i = 0; i < n_simd; i += width) {
+            for (size_t l = 0; l < width; ++l) {
+                xs[l] = world[i + l].x;
+                ys[l] = world[i + l].y;
+            }
+            const auto latitude = Batch::broadcast(2) * simd::atan(simd::exp(Batch::load(ys.data()) / Batch::broadcast(earth_radius))) - Batch::broadcast(pi / 2);
+            (latitude * Batch::broadcast(180) / Batch::broadcast(pi)).store(ys.data());
+            (Batch::load(xs.data()) / Batch::broadcast(earth_radius) * Batch::broadcast(180) / Batch::broadcast(pi)).store(xs.data());
+            for (size_t l = 0; l < width; ++l)
+                lat_long[i + l] = { ys[l], xs[l] };
+        }
+        return n_simd;
+    }
+
+    // latitude and longitude in radians, the results are stored into xs, ys and zs.
+    template <typename Batch>
+    void ecef_lanes(Batch latitude, Batch longitude, Batch altitude, double* xs, double* ys, double* zs)
+    {
+        const auto one = Batch::broadcast(1);
+        const auto e_sq = Batch::broadcast(wgs84_eccentricity_sq);
+        const auto sin_latitude = simd::sin(latitude);
+        const auto cos_latitude = simd::cos(latitude);
+        const auto n = Batch::broadcast(earth_radius) / sqrt(one - e_sq * sin_latitude * sin_latitude);
+        const auto r = (n + altitude) * cos_latitude;
+        (r * simd::cos(longitude)).store(xs);
+        (r * simd::sin(longitude)).store(ys);
+        ((n * (one - e_sq) + altitude) * sin_latitude).store(zs);
+    }
+
+    template <typename Batch>
+    size_t lat_long_alt_to_ecef_range(std::span<const glm::dvec3> lat_long_alt, glm::dvec3* ecef)
+    {
+        constexpr auto width = Batch::width;
+        const auto n_simd = lat_long_alt.size() - lat_long_alt.size() % width;
+        std::array<double, width> xs;
+        std::array<double, width> ys;
+        std::array<double, width> zs;
+        for (size_t i = 0; i < n_simd; i += width) {
+            for (size_t l = 0; l < width; ++l) {
+                xs[l] = lat_long_alt[i + l].x;
+                ys[l] = lat_long_alt[i + l].y;
+                zs[l] = lat_long_alt[i + l].z;
+            }
+            const auto to_radians = Batch::broadcast(pi / 180);
+            ecef_lanes(Batch::load(xs.data()) * to_radians, Batch::load(ys.data()) * to_radians, Batch::load(zs.data()), xs.data(), ys.data(), zs.data());
+            for (size_t l = 0; l < width; ++l)
+                ecef[i + l] = { xs[l], ys[l], zs[l] };
+        }
+        return n_simd;
+    }
+
+    template <typename Batch>
+    size_t world_to_ecef_range(std::span<const glm::dvec3> world, glm::dvec3* ecef)
+    {
+        constexpr auto width = Batch::width;
+        const auto n_simd = world.size() - world.size() % width;
+        std::array<double, width> xs;
+        std::array<double, width> ys;
+        std::array<double, width> zs;
+        for (size_t i = 0; i < n_simd; i += width) {
+            for (size_t l = 0; l < width; ++l) {
+                xs[l] = world[i + l].x;
+                ys[l] = world[i + l].y;
+                zs[l] = world[i + l].z;
+            }
+            const auto latitude = Batch::broadcast(2) * simd::atan(simd::exp(Batch::load(ys.data()) / Batch::broadcast(earth_radius))) - Batch::broadcast(pi / 2);
+            const auto longitude = Batch::load(xs.data()) / Batch::broadcast(earth_radius);
+            ecef_lanes(latitude, longitude, Batch::load(zs.data()), xs.data(), ys.data(), zs.data());
+            for (size_t l = 0; l < width; ++l)
+                ecef[i + l] = { xs[l], ys[l], zs[l] };
+        }
+        return n_simd;
+    }
+
+    // same iteration as the scalar version, both altitude formulas are computed and selected per lane.
+    template <typename Batch>
+    size_t ecef_to_lat_long_alt_range(std::span<const glm::dvec3> ecef, glm::dvec3* lat_long_alt)
+    {
+        constexpr auto width = Batch::width;
+        const auto n_simd = ecef.size() - ecef.size() % width;
+        std::array<double, width> xs;
+        std::array<double, width> ys;
+        std::array<double, width> zs;
+        for (size_t i = 0; i < n_simd; i += width) {
+            for (size_t l = 0; l < width; ++l) {
+                xs[l] = ecef[i + l].x;
+                ys[l] = ecef[i + l].y;
+                zs[l] = ecef[i + l].z;
+            }
+            const auto zero = Batch::broadcast(0);
+            const auto one = Batch::broadcast(1);
+            const auto e_sq = Batch::broadcast(wgs84_eccentricity_sq);
+            const auto radius = Batch::broadcast(earth_radius);
+            const auto x = Batch::load(xs.data());
+            const auto y = Batch::load(ys.data());
+            const auto z = Batch::load(zs.data());
+            const auto p = sqrt(x * x + y * y);
+            const auto longitude = simd::atan2(y, x);
+            auto latitude = simd::atan2(z, p * (one - e_sq));
+            for (int j = 0; j < 3; ++j) {
+                const auto sin_latitude = simd::sin(latitude);
+                const auto n = radius / sqrt(one - e_sq * sin_latitude * sin_latitude);
+                latitude = simd::atan2(z + e_sq * n * sin_latitude, p);
+            }
+            const auto sin_latitude = simd::sin(latitude);
+            const auto cos_latitude = simd::cos(latitude);
+            const auto n = radius / sqrt(one - e_sq * sin_latitude * sin_latitude);
+            const auto abs_cos = select(cos_latitude < zero, zero - cos_latitude, cos_latitude);
+            const auto altitude = select(abs_cos > Batch::broadcast(0.1), p / cos_latitude - n, z / sin_latitude - n * (one - e_sq));
+            const auto to_degrees = Batch::broadcast(180 / pi);
+            (latitude * to_degrees).store(xs.data());
+            (longitude * to_degrees).store(ys.data());
+            altitude.store(zs.data());
+            for (size_t l = 0; l < width; ++l)
+                lat_long_alt[i + l] = { xs[l], ys[l], zs[l] };
+        }
+        return n_simd;
+    }
+} // namespace detail
+
+/// |latitude| < 90
+inline void lat_long_to_world(std::span<const glm::dvec2> lat_long, std::span<glm::dvec2> world)
+{
+    assert(lat_long.size() == world.size());
+    const auto n_processed = detail::lat_long_to_world_range<simd::Batch<double>>(lat_long, world.data());
+    for (size_t i = n_processed; i < lat_long.size(); ++i)
+        world[i] = lat_long_to_world(lat_long[i]);
+}
+
+/// |y| < 700 * earth_radius
+inline void world_to_lat_long(std::span<const glm::dvec2> world, std::span<glm::dvec2> lat_long)
+{
+    assert(lat_long.size() == world.size());
+    const auto n_processed = detail::world_to_lat_long_range<simd::Batch<double>>(world, lat_long.data());
+    for (size_t i = n_processed; i < world.size(); ++i)
+        lat_long[i] = world_to_lat_long(world[i]);
+}
+
+inline void lat_long_alt_to_ecef(std::span<const glm::dvec3> lat_long_alt, std::span<glm::dvec3> ecef)
+{
+    assert(lat_long_alt.size() == ecef.size());
+    const auto n_processed = detail::lat_long_alt_to_ecef_range<simd::Batch<double>>(lat_long_alt, ecef.data());
+    for (size_t i = n_processed; i < lat_long_alt.size(); ++i)
+        ecef[i] = lat_long_alt_to_ecef(lat_long_alt[i]);
+}
+
+inline void ecef_to_lat_long_alt(std::span<const glm::dvec3> ecef, std::span<glm::dvec3> lat_long_alt)
+{
+    assert(lat_long_alt.size() == ecef.size());
+    const auto n_processed = detail::ecef_to_lat_long_alt_range<simd::Batch<double>>(ecef, lat_long_alt.data());
+    for (size_t i = n_processed; i < ecef.size(); ++i)
+        lat_long_alt[i] = ecef_to_lat_long_alt(ecef[i]);
+}
+
+/// |y| < 700 * earth_radius
+inline void world_to_ecef(std::span<const glm::dvec3> world, std::span<glm::dvec3> ecef)
+{
+    assert(world.size() == ecef.size());
+    const auto n_processed = detail::world_to_ecef_range<simd::Batch<double>>(world, ecef.data());
+    for (size_t i = n_processed; i < world.size(); ++i)
+        ecef[i] = world_to_ecef(world[i]);
+}
+
+/// number of tiles (x, y) at zoom level 0, see tile_bounds().
+inline glm::uvec2 root_tiles(int srs_epsg)
+{
+    assert(srs_epsg == epsg_web_mercator || srs_epsg == epsg_wgs84);
+    return srs_epsg == epsg_web_mercator ? glm::uvec2(1, 1) : glm::uvec2(2, 1);
+}
+
+/// srs bounds of a tile, without border.
+/// EPSG:3857: the usual web mercator pyramid, a single tile at zoom level 0.
+/// EPSG:4326: the geodetic pyramid in degrees, 2 x 1 tiles at zoom level 0.
+/// Tms tiles count y from the south, SlippyMap tiles from the north.
+inline tile::SrsBounds tile_bounds(const tile::Id& id, int srs_epsg)
+{
+    assert(srs_epsg == epsg_web_mercator || srs_epsg == epsg_wgs84);
+    const auto web_mercator = srs_epsg == epsg_web_mercator;
+    const auto origin = web_mercator ? glm::dvec2(-web_mercator_extent) : glm::dvec2(-180.0, -90.0);
+    const auto n_y_tiles = double(1u << id.zoom_level);
+    const auto size = (web_mercator ? 2 * web_mercator_extent : 180.0) / n_y_tiles;
+    const auto y = id.scheme == tile::Scheme::Tms ? double(id.coords.y) : n_y_tiles - 1 - double(id.coords.y);
+    const auto min = origin + glm::dvec2(double(id.coords.x), y) * size;
+    return { min, min + glm::dvec2(size) };
+}
+
+/// srs bounds as they are stored in tile::Descriptor. The border pixel extends the bounds by the size of one grid cell
+/// to the east and north.
+inline tile::SrsBounds tile_bounds(const tile::Id& id, int srs_epsg, unsigned grid_size, tile::Border border)
+{
+    assert(grid_size > 0);
+    auto bounds = tile_bounds(id, srs_epsg);
+    bounds.max += bounds.size() * (double(unsigned(border)) / grid_size);
+    return bounds;
+}
+
+inline void tile_bounds(std::span<const tile::Id> ids, int srs_epsg, unsigned grid_size, tile::Border border, std::span<tile::SrsBounds> out)
+{
+    assert(ids.size() == out.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+        out[i] = tile_bounds(ids[i], srs_epsg, grid_size, border);
+}
+
+/// fills Descriptors for many tiles at once. tileSize is grid_size + 1 with a border.
+inline void fill_descriptors(std::span<const tile::Id> ids, int srs_epsg, unsigned grid_size, tile::Border border, std::span<tile::Descriptor> out)
+{
+    assert(ids.size() == out.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+        out[i] = { ids[i], tile_bounds(ids[i], srs_epsg, grid_size, border), srs_epsg, grid_size, grid_size + unsigned(border) };
+}
+
+} // namespace radix::srs
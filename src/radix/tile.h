@@ -21,10 +21,14 @@
 
 #include "geometry.h"
 #include "hasher.h"
+#include "morton.h"
+#include <cassert>
+#include <charconv>
 #include <glm/glm.hpp>
 #include <glm/gtx/string_cast.hpp>
 #include <glm/vector_relational.hpp>
 #include <iostream>
+#include <optional>
 #include <tuple>
 #include <unordered_set>
 
@@ -52,7 +56,7 @@ struct Id {
     glm::uvec2 coords = {};
     Scheme scheme = Scheme::Tms;
 
-    [[nodiscard]] Id to(Scheme new_scheme) const
+    [[nodiscard]] constexpr Id to(Scheme new_scheme) const
     {
         if (scheme == new_scheme)
             return *this;
@@ -109,21 +113,175 @@ inline QuadPosition quad_position(const Id& id)
     return QuadPosition(2 * y_comp + x_comp);
 }
 
+enum class Direction { East, West, North, South };
+
+/// true if ancestor is an ancestor of id, or the same tile.
+inline bool covers(const Id& ancestor, const Id& id)
+{
+    assert(ancestor.scheme == id.scheme);
+    return ancestor.zoom_level <= id.zoom_level && (id.coords / (1u << (id.zoom_level - ancestor.zoom_level))) == ancestor.coords;
+}
+
+/// the neighbouring tile on the same zoom level. x wraps around the globe, there is nothing north or south of the poles.
+inline std::optional<Id> neighbour(const Id& id, Direction direction)
+{
+    const auto max_coord = (1u << id.zoom_level) - 1;
+    const auto towards_max_y = (direction == Direction::North) == (id.scheme == Scheme::Tms);
+    switch (direction) {
+    case Direction::East:
+        return Id { id.zoom_level, { (id.coords.x + 1) & max_coord, id.coords.y }, id.scheme };
+    case Direction::West:
+        return Id { id.zoom_level, { (id.coords.x - 1) & max_coord, id.coords.y }, id.scheme };
+    case Direction::North:
+    case Direction::South:
+        if (towards_max_y)
+            return id.coords.y == max_coord ? std::nullopt : std::optional(Id { id.zoom_level, { id.coords.x, id.coords.y + 1 }, id.scheme });
+        return id.coords.y == 0 ? std::nullopt : std::optional(Id { id.zoom_level, { id.coords.x, id.coords.y - 1 }, id.scheme });
+    }
+    return {};
+}
+
+/// the same for tiles stored as Morton codes of their coordinates (e.g., keys of sorted tile arrays), without decoding.
+inline std::optional<uint64_t> neighbour(uint64_t morton_code, unsigned zoom_level, Scheme scheme, Direction direction)
+{
+    const auto mask = morton::level_mask(zoom_level);
+    const auto y_bits = mask & morton::detail::y_bits;
+    const auto towards_max_y = (direction == Direction::North) == (scheme == Scheme::Tms);
+    switch (direction) {
+    case Direction::East:
+        return morton::increment_x(morton_code) & mask;
+    case Direction::West:
+        return morton::decrement_x(morton_code) & mask;
+    case Direction::North:
+    case Direction::South:
+        if (towards_max_y)
+            return (morton_code & y_bits) == y_bits ? std::nullopt : std::optional(morton::increment_y(morton_code));
+        return (morton_code & y_bits) == 0 ? std::nullopt : std::optional(morton::decrement_y(morton_code));
+    }
+    return {};
+}
+
 using IdSet = std::unordered_set<tile::Id, tile::Id::Hasher>;
 template <typename T> using IdMap = std::unordered_map<tile::Id, T, tile::Id::Hasher>;
 
-inline std::string to_string(const Id& value)
+namespace detail {
+    constexpr char* write_unsigned(char* first, char* last, unsigned value)
+    {
+        char digits[10] = {};
+        unsigned n = 0;
+        do {
+            digits[n++] = char('0' + value % 10);
+            value /= 10;
+        } while (value);
+        if (last - first < std::ptrdiff_t(n))
+            return nullptr;
+        while (n)
+            *first++ = digits[--n];
+        return first;
+    }
+
+    // returns nullptr if there are no digits, or the value doesn't fit into unsigned.
+    constexpr const char* read_unsigned(const char* first, const char* last, unsigned* value)
+    {
+        uint64_t v = 0;
+        const auto* p = first;
+        for (; p != last && *p >= '0' && *p <= '9'; ++p) {
+            v = v * 10 + unsigned(*p - '0');
+            if (v > 0xFFFF'FFFFu)
+                return nullptr;
+        }
+        if (p == first)
+            return nullptr;
+        *value = unsigned(v);
+        return p;
+    }
+} // namespace detail
+
+/// the longest z/x/y string, 31/2147483647/2147483647
+constexpr std::size_t max_zxy_chars = 2 + 1 + 10 + 1 + 10;
+/// quadkeys have one digit per zoom level
+constexpr std::size_t max_quadkey_chars = 31;
+
+/// writes "zoom/x/y" (coordinates in the scheme of the id) to [first, last), without allocation or a terminating 0.
+/// errc::value_too_large (and ptr == last) if the buffer is too small, like std::to_chars.
+constexpr std::to_chars_result to_chars(char* first, char* last, const Id& id)
 {
-    std::string scheme;
-    switch (value.scheme) {
-    case Scheme::Tms:
-        scheme = "Tms";
-        break;
-    case Scheme::SlippyMap:
-        scheme = "SlippyMap";
-        break;
+    auto* p = detail::write_unsigned(first, last, id.zoom_level);
+    for (const auto coord : { id.coords.x, id.coords.y }) {
+        if (!p || p == last)
+            return { last, std::errc::value_too_large };
+        *p++ = '/';
+        p = detail::write_unsigned(p, last, coord);
+    }
+    if (!p)
+        return { last, std::errc::value_too_large };
+    return { p, std::errc() };
+}
+
+/// parses "zoom/x/y" (in the given scheme), the inverse of to_chars. like std::from_chars, parsing stops after y, and
+/// errc::invalid_argument (ptr == first) is returned for malformed input. errc::result_out_of_range is returned for
+/// zoom levels above 31 and coordinates outside of the zoom level.
+constexpr std::from_chars_result from_chars(const char* first, const char* last, Id& id, Scheme scheme = Scheme::Tms)
+{
+    unsigned values[3] = {};
+    const auto* p = first;
+    for (unsigned i = 0; i < 3; ++i) {
+        if (i > 0) {
+            if (p == last || *p != '/')
+                return { first, std::errc::invalid_argument };
+            ++p;
+        }
+        p = detail::read_unsigned(p, last, &values[i]);
+        if (!p)
+            return { first, std::errc::invalid_argument };
+    }
+    if (values[0] > 31 || values[1] >= (1u << values[0]) || values[2] >= (1u << values[0]))
+        return { p, std::errc::result_out_of_range };
+    id = { values[0], { values[1], values[2] }, scheme };
+    return { p, std::errc() };
+}
+
+/// writes the Bing maps quadkey of the id (one digit per zoom level, computed in the SlippyMap scheme; empty for the
+/// root tile).
+constexpr std::to_chars_result to_quadkey(char* first, char* last, const Id& id)
+{
+    if (last - first < std::ptrdiff_t(id.zoom_level))
+        return { last, std::errc::value_too_large };
+    const auto slippy = id.to(Scheme::SlippyMap);
+    for (unsigned level = id.zoom_level; level > 0; --level) {
+        const auto bit = level - 1;
+        *first++ = char('0' + ((slippy.coords.x >> bit) & 1) + 2 * ((slippy.coords.y >> bit) & 1));
     }
-    return scheme + ":" + std::to_string(value.zoom_level) + "/" + std::to_string(value.coords.x) + "/" + std::to_string(value.coords.y);
+    return { first, std::errc() };
+}
+
+/// parses a quadkey (all characters up to the first non quadkey digit), the result is converted to scheme.
+constexpr std::from_chars_result from_quadkey(const char* first, const char* last, Id& id, Scheme scheme = Scheme::Tms)
+{
+    glm::uvec2 coords = { 0, 0 };
+    unsigned zoom_level = 0;
+    const auto* p = first;
+    for (; p != last && *p >= '0' && *p <= '3'; ++p) {
+        if (zoom_level == 31)
+            return { p, std::errc::result_out_of_range };
+        const auto digit = unsigned(*p - '0');
+        coords = { coords.x * 2 + (digit & 1), coords.y * 2 + (digit >> 1) };
+        ++zoom_level;
+    }
+    id = Id { zoom_level, coords, Scheme::SlippyMap }.to(scheme);
+    return { p, std::errc() };
+}
+
+/// "scheme:zoom/x/y". also used for catch2 output, so it has to work for invalid ids (e.g., a zoom_level of unsigned(-1)).
+inline std::string to_string(const Id& value)
+{
+    // "SlippyMap:" and three 10 digit unsigned values
+    std::array<char, 10 + 3 * 10 + 2> buffer = {};
+    const auto* scheme = value.scheme == Scheme::Tms ? "Tms:" : "SlippyMap:";
+    auto* p = std::copy(scheme, scheme + std::char_traits<char>::length(scheme), buffer.data());
+    const auto result = to_chars(p, buffer.data() + buffer.size(), value);
+    assert(result.ec == std::errc());
+    return std::string(buffer.data(), result.ptr);
 }
 
 // helper for catch2
@@ -0,0 +1,236 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "morton.h"
+#include "simd.h"
+#include "sort.h"
+#include "srs.h"
+#include "tile.h"
+
+// Batch operations on many points or tile ids at once.
+//
+// Points are projected srs coordinates (e.g., web mercator). A point belongs to the tile whose half open bounds
+// contain it, points outside the root tile (and NaNs) are clamped to the border tiles.
+
+namespace radix::tile {
+
+namespace detail {
+    // truncation is floor, as the values are clamped to [0, max_coord] first. NaNs become 0.
+    template <typename Batch>
+    size_t tile_coords_range(std::span<const glm::dvec2> points, const glm::dvec2& origin, const glm::dvec2& scale, double max_coord, glm::uvec2* out)
+    {
+        constexpr auto width = Batch::width;
+        if constexpr (width < 2) {
+            return 0;
+        } else {
+            static_assert(width % 2 == 0);
+            const auto n_values = points.size() * 2 - (points.size() * 2) % width;
+            if (n_values == 0)
+                return 0;
+            std::array<double, width> lanes;
+            for (size_t l = 0; l < width; ++l)
+                lanes[l] = origin[glm::length_t(l % 2)];
+            const auto o = Batch::load(lanes.data());
+            for (size_t l = 0; l < width; ++l)
+                lanes[l] = scale[glm::length_t(l % 2)];
+            const auto s = Batch::load(lanes.data());
+            const auto zero = Batch::broadcast(0);
+            const auto upper = Batch::broadcast(max_coord);
+
+            // max_coord < 2^31, the clamped values fit into int32
+            const double* data = &points.front().x;
+            auto* coords = reinterpret_cast<int32_t*>(&out->x);
+            for (size_t i = 0; i < n_values; i += width)
+                min(upper, max((Batch::load(data + i) - o) * s, zero)).store_truncated(coords + i);
+            return n_values / 2;
+        }
+    }
+
+    inline void tile_coords(std::span<const glm::dvec2> points, unsigned zoom_level, Scheme scheme, const SrsBounds& root_bounds, glm::uvec2* out)
+    {
+        assert(zoom_level < 32);
+        const auto n_tiles = double(uint64_t(1) << zoom_level);
+        const auto scale = n_tiles / root_bounds.size();
+        const auto max_coord = n_tiles - 1;
+        const auto n_processed = tile_coords_range<simd::Batch<double>>(points, root_bounds.min, scale, max_coord, out);
+        for (size_t i = n_processed; i < points.size(); ++i) {
+            const auto v = (points[i] - root_bounds.min) * scale;
+            // negated comparisons, so that NaNs become 0
+            out[i] = { unsigned(!(v.x > 0) ? 0 : (v.x < max_coord ? v.x : max_coord)), unsigned(!(v.y > 0) ? 0 : (v.y < max_coord ? v.y : max_coord)) };
+        }
+        if (scheme == Scheme::SlippyMap) {
+            const auto max_y = unsigned(max_coord);
+            for (size_t i = 0; i < points.size(); ++i)
+                out[i].y = max_y - out[i].y;
+        }
+    }
+} // namespace detail
+
+/// tile coordinates of points on zoom_level (in the given scheme). root_bounds are the srs bounds of the zoom level 0 tile.
+inline void to_coords(std::span<const glm::dvec2> points, unsigned zoom_level, Scheme scheme, const SrsBounds& root_bounds, std::span<glm::uvec2> out)
+{
+    assert(points.size() == out.size());
+    detail::tile_coords(points, zoom_level, scheme, root_bounds, out.data());
+}
+
+/// tile ids of points on zoom_level.
+inline void to_ids(std::span<const glm::dvec2> points, unsigned zoom_level, Scheme scheme, const SrsBounds& root_bounds, std::span<Id> out)
+{
+    assert(points.size() == out.size());
+    constexpr size_t chunk_size = 256;
+    std::array<glm::uvec2, chunk_size> coords;
+    for (size_t begin = 0; begin < points.size(); begin += chunk_size) {
+        const auto chunk = points.subspan(begin, std::min(chunk_size, points.size() - begin));
+        detail::tile_coords(chunk, zoom_level, scheme, root_bounds, coords.data());
+        for (size_t i = 0; i < chunk.size(); ++i)
+            out[begin + i] = { zoom_level, coords[i], scheme };
+    }
+}
+
+/// converts ids in place, the same as Id::to() for every element, branch free.
+inline void to_scheme(std::span<Id> ids, Scheme scheme)
+{
+    static_assert(unsigned(Scheme::Tms) == 0 && unsigned(Scheme::SlippyMap) == 1);
+    for (auto& id : ids) {
+        // for y < 2^zoom_level, 2^zoom_level - 1 - y only flips the low zoom_level bits
+        const auto flip = unsigned(id.scheme) ^ unsigned(scheme);
+        id.coords.y ^= ((1u << id.zoom_level) - 1) & (0u - flip);
+        id.scheme = scheme;
+    }
+}
+
+/// the same as quad_position() for every element, branch free.
+inline void quad_positions(std::span<const Id> ids, std::span<QuadPosition> out)
+{
+    assert(ids.size() == out.size());
+    static_assert(unsigned(QuadPosition::BottomLeft) == 2);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        const auto& id = ids[i];
+        // on the bottom if y is even in Tms, or odd in SlippyMap
+        const auto bottom = 1u ^ (id.coords.y & 1u) ^ unsigned(id.scheme);
+        out[i] = QuadPosition((id.coords.x & 1u) | (bottom << 1));
+    }
+}
+
+namespace detail {
+    template <typename Batch>
+    size_t flip_y_range(std::span<const unsigned> zoom_levels, std::span<unsigned> ys)
+    {
+        constexpr auto width = Batch::width;
+        const auto n_simd = ys.size() - ys.size() % width;
+        const auto one = Batch::broadcast(1);
+        for (size_t i = 0; i < n_simd; i += width)
+            (Batch::load(ys.data() + i) ^ (pow2(Batch::load(zoom_levels.data() + i)) - one)).store(ys.data() + i);
+        return n_simd;
+    }
+
+    template <typename Batch>
+    size_t quad_positions_range(std::span<const unsigned> xs, std::span<const unsigned> ys, Scheme scheme, QuadPosition* out)
+    {
+        constexpr auto width = Batch::width;
+        const auto n_simd = xs.size() - xs.size() % width;
+        const auto one = Batch::broadcast(1);
+        const auto bottom_if_even = Batch::broadcast(1u ^ unsigned(scheme));
+        std::array<unsigned, width> lanes;
+        for (size_t i = 0; i < n_simd; i += width) {
+            const auto bottom = (Batch::load(ys.data() + i) & one) ^ bottom_if_even;
+            ((Batch::load(xs.data() + i) & one) | (bottom + bottom)).store(lanes.data());
+            for (size_t l = 0; l < width; ++l)
+                out[i + l] = QuadPosition(lanes[l]);
+        }
+        return n_simd;
+    }
+} // namespace detail
+
+/// the same as Id::to() in structure of arrays layout (e.g., gpu buffers): converts the y coordinates of tiles on
+/// zoom_levels in place from scheme `from` to scheme `to`.
+inline void to_scheme(std::span<const unsigned> zoom_levels, std::span<unsigned> ys, Scheme from, Scheme to)
+{
+    assert(zoom_levels.size() == ys.size());
+    if (from == to)
+        return;
+    const auto n_processed = detail::flip_y_range<simd::Batch<unsigned>>(zoom_levels, ys);
+    for (size_t i = n_processed; i < ys.size(); ++i)
+        ys[i] ^= (1u << zoom_levels[i]) - 1;
+}
+
+/// the same as quad_position() in structure of arrays layout, for tiles in the given scheme.
+inline void quad_positions(std::span<const unsigned> xs, std::span<const unsigned> ys, Scheme scheme, std::span<QuadPosition> out)
+{
+    assert(xs.size() == ys.size() && xs.size() == out.size());
+    const auto n_processed = detail::quad_positions_range<simd::Batch<unsigned>>(xs, ys, scheme, out.data());
+    for (size_t i = n_processed; i < xs.size(); ++i)
+        out[i] = QuadPosition((xs[i] & 1u) | ((1u ^ (ys[i] & 1u) ^ unsigned(scheme)) << 1));
+}
+
+/// points grouped by tile, in compressed sparse row layout: the points of tile ids[i] are
+/// indices[offsets[i]] .. indices[offsets[i + 1]] (indices into the original point span, ascending per tile).
+/// tiles are sorted in Morton order of their coordinates.
+struct PointBuckets {
+    std::vector<Id> ids;
+    std::vector<uint32_t> offsets; // ids.size() + 1 entries
+    std::vector<uint32_t> indices;
+
+    [[nodiscard]] size_t size() const { return ids.size(); }
+    [[nodiscard]] std::span<const uint32_t> points(size_t bucket) const
+    {
+        return std::span(indices).subspan(offsets[bucket], offsets[bucket + 1] - offsets[bucket]);
+    }
+};
+
+/// groups points by the tile containing them on zoom_level, without per point allocations or hashing.
+inline PointBuckets bucket_points(std::span<const glm::dvec2> points, unsigned zoom_level, Scheme scheme = Scheme::Tms,
+    const SrsBounds& root_bounds = srs::tile_bounds({ 0, { 0, 0 } }, srs::epsg_web_mercator))
+{
+    assert(points.size() < uint64_t(std::numeric_limits<uint32_t>::max()));
+    std::vector<glm::uvec2> coords(points.size());
+    detail::tile_coords(points, zoom_level, scheme, root_bounds, coords.data());
+
+    std::vector<uint64_t> keys(points.size());
+    PointBuckets buckets;
+    buckets.indices.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        keys[i] = morton::encode(coords[i]);
+        buckets.indices[i] = uint32_t(i);
+    }
+    coords = {};
+    radix_sort(std::span(keys), std::span(buckets.indices));
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (i == 0 || keys[i] != keys[i - 1]) {
+            buckets.ids.push_back({ zoom_level, morton::decode(keys[i]), scheme });
+            buckets.offsets.push_back(uint32_t(i));
+        }
+    }
+    buckets.offsets.push_back(uint32_t(keys.size()));
+    return buckets;
+}
+
+} // namespace radix::tile
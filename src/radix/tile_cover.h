@@ -0,0 +1,159 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+
+#include "morton.h"
+#include "srs.h"
+#include "tile.h"
+
+namespace radix::tile {
+
+enum class CoverOrder {
+    RowMajor, // y (in the requested scheme) first, then x
+    Morton
+};
+
+// The tiles of one zoom level that cover a region, computed directly on that level (no traversal of coarser levels,
+// no allocation). Tiles are half open, i.e., tiles that only touch the region with their min edge are not included.
+// The pyramid may have several tiles on zoom level 0 (root_tiles, e.g., 2 x 1 for EPSG:4326), root_bounds are the
+// bounds of tile (0, 0) on zoom level 0, the others are placed east and north of it.
+class Cover {
+public:
+    class Iterator {
+    public:
+        // operator* returns by value, which is only allowed for C++20 forward iterators
+        using iterator_category = std::input_iterator_tag;
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type = Id;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Id*;
+        using reference = Id;
+
+        Iterator() = default;
+        Iterator(const Cover* cover, bool end)
+            : m_cover(cover)
+            , m_end(end || cover->empty())
+            , m_coords(cover->m_min)
+        {
+        }
+
+        [[nodiscard]] Id operator*() const { return { m_cover->m_zoom_level, m_coords, m_cover->m_scheme }; }
+        Iterator& operator++()
+        {
+            if (m_coords == m_cover->m_max) {
+                m_end = true;
+                return *this;
+            }
+            if (m_cover->m_order == CoverOrder::RowMajor) {
+                if (m_coords.x == m_cover->m_max.x)
+                    m_coords = { m_cover->m_min.x, m_coords.y + 1 };
+                else
+                    ++m_coords.x;
+                return *this;
+            }
+            const auto min = morton::encode(m_cover->m_min);
+            const auto max = morton::encode(m_cover->m_max);
+            auto code = morton::encode(m_coords) + 1;
+            if (!morton::in_rect(code, min, max))
+                code = morton::next_in_rect(code, min, max);
+            m_coords = morton::decode(code);
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+        bool operator==(const Iterator& other) const { return m_end == other.m_end && (m_end || m_coords == other.m_coords); }
+
+    private:
+        const Cover* m_cover = nullptr;
+        bool m_end = true;
+        glm::uvec2 m_coords = {};
+    };
+
+    Cover(const SrsBounds& region, unsigned zoom_level, Scheme scheme, const SrsBounds& root_bounds, CoverOrder order, const glm::uvec2& root_tiles = { 1, 1 })
+        : m_zoom_level(zoom_level)
+        , m_scheme(scheme)
+        , m_order(order)
+    {
+        assert(zoom_level < 32);
+        assert(root_tiles.x > 0 && root_tiles.y > 0);
+        assert((uint64_t(std::max(root_tiles.x, root_tiles.y)) << zoom_level) <= (uint64_t(1) << 32));
+        const auto tiles_per_root = double(uint64_t(1) << zoom_level);
+        const auto n_tiles = glm::dvec2(root_tiles) * tiles_per_root;
+        const auto origin = root_bounds.min;
+        const auto extent_max = origin + root_bounds.size() * glm::dvec2(root_tiles);
+        // the max edges are exclusive. a region whose max is on the min edge only touches the tiles, unless it's a
+        // point (or line) on it. the negated comparisons also catch NaNs.
+        if (!(region.min.x < extent_max.x && region.min.y < extent_max.y && (region.max.x > origin.x || region.min.x >= origin.x)
+                && (region.max.y > origin.y || region.min.y >= origin.y) && region.min.x <= region.max.x && region.min.y <= region.max.y)) {
+            m_empty = true;
+            return;
+        }
+        const auto first = glm::floor((region.min - origin) / root_bounds.size() * tiles_per_root);
+        const auto last = glm::max(first, glm::ceil((region.max - origin) / root_bounds.size() * tiles_per_root) - 1.0);
+        const auto clamp = [&](const glm::dvec2& v) { return glm::uvec2(glm::clamp(v, glm::dvec2(0.0), n_tiles - 1.0)); };
+        m_min = clamp(first);
+        m_max = clamp(last);
+        if (scheme == Scheme::SlippyMap) {
+            const auto max_y = unsigned(n_tiles.y - 1);
+            std::tie(m_min.y, m_max.y) = std::make_pair(max_y - m_max.y, max_y - m_min.y);
+        }
+    }
+
+    [[nodiscard]] Iterator begin() const { return { this, false }; }
+    [[nodiscard]] Iterator end() const { return { this, true }; }
+    [[nodiscard]] bool empty() const { return m_empty; }
+    [[nodiscard]] size_t size() const { return m_empty ? 0 : size_t(m_max.x - m_min.x + 1) * size_t(m_max.y - m_min.y + 1); }
+    /// the first and last tile coordinates (inclusive, in the requested scheme), undefined if empty.
+    [[nodiscard]] glm::uvec2 min() const { return m_min; }
+    [[nodiscard]] glm::uvec2 max() const { return m_max; }
+
+private:
+    unsigned m_zoom_level;
+    Scheme m_scheme;
+    CoverOrder m_order;
+    bool m_empty = false;
+    glm::uvec2 m_min = {};
+    glm::uvec2 m_max = {};
+};
+
+/// tiles on zoom_level covering region, in a pyramid with a single zoom level 0 tile. root_bounds are the srs bounds of
+/// that tile, web mercator by default. the returned range must outlive its iterators.
+inline Cover cover(const SrsBounds& region, unsigned zoom_level, Scheme scheme = Scheme::Tms,
+    const SrsBounds& root_bounds = srs::tile_bounds({ 0, { 0, 0 } }, srs::epsg_web_mercator), CoverOrder order = CoverOrder::RowMajor)
+{
+    return { region, zoom_level, scheme, root_bounds, order };
+}
+
+/// tiles on zoom_level covering region (in srs_epsg coordinates), in the pyramid of srs::tile_bounds().
+inline Cover cover(const SrsBounds& region, unsigned zoom_level, Scheme scheme, int srs_epsg, CoverOrder order = CoverOrder::RowMajor)
+{
+    return { region, zoom_level, scheme, srs::tile_bounds({ 0, { 0, 0 } }, srs_epsg), order, srs::root_tiles(srs_epsg) };
+}
+
+} // namespace radix::tile
@@ -0,0 +1,176 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <cmath>
+#include <memory>
+#include <random>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <radix/camera_relative.h>
+
+using namespace radix;
+
+namespace {
+// somewhere in the alps, in ecef coordinates
+const auto camera_position = glm::dvec3(4'200'000.123456789, 1'100'000.987654321, 4'700'000.5);
+
+std::vector<geometry::Aabb3d> random_boxes(size_t n, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> position(-20'000, 20'000);
+    std::uniform_real_distribution<double> extent(0, 2'000);
+    std::vector<geometry::Aabb3d> boxes;
+    for (size_t i = 0; i < n; ++i) {
+        const auto min = camera_position + glm::dvec3(position(rng), position(rng), position(rng));
+        boxes.push_back({ min, min + glm::dvec3(extent(rng), extent(rng), extent(rng)) });
+    }
+    return boxes;
+}
+
+geometry::Frustum<double> test_frustum()
+{
+    // box shaped region around a point in front of the camera
+    const auto centre = camera_position + glm::dvec3(1'000, 2'000, -500);
+    const auto plane = [&](glm::dvec3 normal, double offset) {
+        normal = glm::normalize(normal);
+        return geometry::Plane<double> { normal, offset - glm::dot(normal, centre) };
+    };
+    return {
+        plane({ 1, 0.2, 0 }, 10'000),
+        plane({ -1, 0.1, 0 }, 8'000),
+        plane({ 0, 1, -0.3 }, 6'000),
+        plane({ 0, -1, 0 }, 12'000),
+        plane({ 0.1, 0, 1 }, 4'000),
+        plane({ 0, 0, -1 }, 14'000),
+    };
+}
+} // namespace
+
+TEST_CASE("radix/camera_relative: rounding boxes outward")
+{
+    const auto boxes = random_boxes(1000, 1);
+    for (const auto& box : boxes) {
+        const auto relative = geometry::to_relative(box, camera_position);
+        for (glm::length_t d = 0; d < 3; ++d) {
+            // long double makes the subtraction exact on x86, elsewhere this is at least not wrong
+            const auto exact_min = (long double)(box.min[d]) - (long double)(camera_position[d]);
+            const auto exact_max = (long double)(box.max[d]) - (long double)(camera_position[d]);
+            CHECK((long double)(relative.min[d]) <= exact_min);
+            CHECK((long double)(relative.max[d]) >= exact_max);
+            // and tight
+            CHECK((long double)(std::nextafter(relative.min[d], std::numeric_limits<float>::infinity())) > exact_min);
+            CHECK((long double)(std::nextafter(relative.max[d], -std::numeric_limits<float>::infinity())) < exact_max);
+        }
+    }
+    // exactly representable values are not inflated
+    const auto relative = geometry::to_relative(geometry::Aabb3d { { 1.5, 2.0, 3.25 }, { 4.0, 5.0, 6.0 } }, glm::dvec3(1.0));
+    CHECK(relative == geometry::Aabb3f { { 0.5f, 1.0f, 2.25f }, { 3.0f, 4.0f, 5.0f } });
+}
+
+TEST_CASE("radix/camera_relative: conservative tests")
+{
+    const auto boxes = random_boxes(10'003, 2);
+    const auto batch = geometry::RelativeAabbBatch(camera_position, boxes);
+    REQUIRE(batch.size() == boxes.size());
+
+    SECTION("classify")
+    {
+        const auto planes = test_frustum();
+        std::vector<geometry::Classification> result(batch.size());
+        geometry::classify(batch, planes, std::span(result));
+        size_t n_same = 0;
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            const auto exact = geometry::classify(boxes[i], planes);
+            if (result[i] != geometry::Classification::Intersecting)
+                CHECK(result[i] == exact);
+            n_same += result[i] == exact;
+        }
+        // the margins are in the millimetre range, they should practically never make a difference
+        CHECK(n_same > boxes.size() - 10);
+    }
+
+    SECTION("classify boxes touching a plane")
+    {
+        // planes through the corners of the boxes. the double precision classification is Inside or Intersecting,
+        // the rounding errors of the float version must not turn that into Outside.
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<double> component(-1, 1);
+        for (size_t i = 0; i < 1000; ++i) {
+            const auto& box = boxes[i];
+            const auto normal = glm::normalize(glm::dvec3(component(rng), component(rng), component(rng)));
+            const auto plane = geometry::Plane<double> { normal, -glm::dot(normal, geometry::positive_vertex(box, normal)) };
+            const auto single = geometry::RelativeAabbBatch(camera_position, std::span(boxes).subspan(i, 1));
+            std::array<geometry::Classification, 1> result = {};
+            geometry::classify(single, std::array { plane }, std::span<geometry::Classification>(result));
+            CHECK(result[0] == geometry::Classification::Intersecting);
+        }
+    }
+
+    SECTION("intersect")
+    {
+        const auto query = geometry::Aabb3d { camera_position - glm::dvec3(3'000), camera_position + glm::dvec3(5'000, 1'000, 2'000) };
+        std::unique_ptr<bool[]> result(new bool[boxes.size()]);
+        geometry::intersect(batch, query, std::span(result.get(), boxes.size()));
+        size_t n_intersecting = 0;
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            if (geometry::intersect(boxes[i], query))
+                CHECK(result[i]);
+            n_intersecting += result[i];
+        }
+        CHECK(n_intersecting > 0);
+
+        // touching in one point
+        const auto touching = geometry::Aabb3d { boxes[0].max, boxes[0].max + glm::dvec3(1.0) };
+        geometry::intersect(batch, touching, std::span(result.get(), boxes.size()));
+        CHECK(result[0]);
+    }
+
+    SECTION("distance")
+    {
+        const auto point = camera_position + glm::dvec3(0.01, -0.02, 1.7);
+        std::vector<float> distances(boxes.size());
+        geometry::distance_sq_lower_bound(batch, point, std::span(distances));
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            const auto exact = geometry::distance_sq(boxes[i], point);
+            CHECK(double(distances[i]) <= exact);
+            CHECK(double(distances[i]) >= exact * (1 - 0.00001) - 0.0001);
+        }
+    }
+}
+
+TEST_CASE("radix/camera_relative: performance")
+{
+    const auto boxes = random_boxes(100'000, 4);
+    const auto planes = test_frustum();
+    const auto double_batch = geometry::AabbBatch<3, double>(std::span(boxes));
+    const auto float_batch = geometry::RelativeAabbBatch(camera_position, boxes);
+    std::vector<geometry::Classification> result(boxes.size());
+
+    BENCHMARK("double classify (100k boxes)")
+    {
+        geometry::classify(double_batch, planes, std::span(result));
+        return result.back();
+    };
+    BENCHMARK("camera relative float classify (100k boxes)")
+    {
+        geometry::classify(float_batch, planes, std::span(result));
+        return result.back();
+    };
+}
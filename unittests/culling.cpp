@@ -0,0 +1,100 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <radix/culling.h>
+#include <radix/tile.h>
+
+using namespace radix;
+
+namespace {
+geometry::Aabb3d unit_square_bounds(const tile::Id& id)
+{
+    const auto size = 1.0 / double(1u << id.zoom_level);
+    const auto min = glm::dvec2(id.coords) * size;
+    return { { min.x, min.y, 0.0 }, { min.x + size, min.y + size, 0.1 } };
+}
+} // namespace
+
+TEST_CASE("radix/culling: classify with plane mask")
+{
+    const auto planes = std::array {
+        geometry::Plane<double> { { 1, 0, 0 }, 0 }, // x > 0
+        geometry::Plane<double> { { -1, 0, 0 }, 0.5 }, // x < 0.5
+    };
+    {
+        const auto [c, mask] = geometry::classify(geometry::Aabb3d { { 0.1, 0, 0 }, { 0.2, 1, 1 } }, planes, 3u);
+        CHECK(c == geometry::Classification::Inside);
+        CHECK(mask == 0u);
+    }
+    {
+        const auto [c, mask] = geometry::classify(geometry::Aabb3d { { 0.1, 0, 0 }, { 0.7, 1, 1 } }, planes, 3u);
+        CHECK(c == geometry::Classification::Intersecting);
+        CHECK(mask == 2u);
+    }
+    {
+        const auto [c, mask] = geometry::classify(geometry::Aabb3d { { 0.6, 0, 0 }, { 0.7, 1, 1 } }, planes, 1u);
+        CHECK(c == geometry::Classification::Inside); // second plane is not tested
+        CHECK(mask == 0u);
+    }
+    {
+        const auto [c, mask] = geometry::classify(geometry::Aabb3d { { 0.6, 0, 0 }, { 0.7, 1, 1 } }, planes, 3u);
+        CHECK(c == geometry::Classification::Outside);
+    }
+}
+
+TEST_CASE("radix/culling: frustum culled on the fly traverse")
+{
+    const auto planes = std::array {
+        geometry::Plane<double> { glm::normalize(glm::dvec3 { 1, 0.3, 0 }), -0.2 },
+        geometry::Plane<double> { glm::normalize(glm::dvec3 { -1, 0.1, 0 }), 0.7 },
+        geometry::Plane<double> { glm::normalize(glm::dvec3 { 0, 1, 0.2 }), -0.1 },
+        geometry::Plane<double> { glm::normalize(glm::dvec3 { 0, -1, 0 }), 0.8 },
+    };
+    const auto predicate = [](const tile::Id& id) { return id.zoom_level < 7; };
+    const auto generate_children = [](const tile::Id& id) { return id.children(); };
+    const auto root = tile::Id { 0, { 0, 0 } };
+
+    unsigned n_bounds_calls = 0;
+    const auto counting_bounds = [&](const tile::Id& id) {
+        ++n_bounds_calls;
+        return unit_square_bounds(id);
+    };
+    const auto leaves = quad_tree::onTheFlyTraverseFrustumCulled(root, planes, counting_bounds, predicate, generate_children);
+
+    // reference: full traversal, filtered afterwards
+    const auto all_leaves = quad_tree::onTheFlyTraverse(root, predicate, generate_children);
+    std::vector<tile::Id> reference;
+    std::copy_if(all_leaves.begin(), all_leaves.end(), std::back_inserter(reference), [&](const tile::Id& id) {
+        return geometry::classify(unit_square_bounds(id), planes) != geometry::Classification::Outside;
+    });
+    CHECK(leaves == reference);
+    CHECK(!leaves.empty());
+    CHECK(leaves.size() < all_leaves.size());
+
+    // subtrees completely inside are not tested
+    unsigned n_visited = 0;
+    quad_tree::onTheFlyTraverse(
+        root, [&](const tile::Id& id) { return predicate(id) && geometry::classify(unit_square_bounds(id), planes) != geometry::Classification::Outside; },
+        [&](const tile::Id& id) {
+            n_visited += 4;
+            return id.children();
+        });
+    CHECK(n_bounds_calls < n_visited / 2);
+}
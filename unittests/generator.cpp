@@ -0,0 +1,89 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <radix/generator.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+radix::generator<int> iota(int n, int* n_produced)
+{
+    for (int i = 0; i < n; ++i) {
+        ++(*n_produced);
+        co_yield i;
+    }
+}
+
+radix::generator<std::string> throwing()
+{
+    co_yield "first";
+    throw std::runtime_error("second");
+}
+} // namespace
+
+TEST_CASE("radix/generator")
+{
+    SECTION("yields all values in order")
+    {
+        int n_produced = 0;
+        std::vector<int> values;
+        for (const auto v : iota(5, &n_produced))
+            values.push_back(v);
+        CHECK(values == std::vector({ 0, 1, 2, 3, 4 }));
+        CHECK(n_produced == 5);
+    }
+    SECTION("is lazy")
+    {
+        int n_produced = 0;
+        auto gen = iota(1000, &n_produced);
+        CHECK(n_produced == 0);
+        for (const auto v : gen) {
+            if (v == 2)
+                break;
+        }
+        CHECK(n_produced == 3);
+    }
+    SECTION("empty and moved from")
+    {
+        int n_produced = 0;
+        auto gen = iota(0, &n_produced);
+        CHECK(gen.begin() == gen.end());
+
+        auto gen2 = iota(3, &n_produced);
+        auto gen3 = std::move(gen2);
+        CHECK(gen2.begin() == gen2.end());
+        CHECK(*gen3.begin() == 0);
+    }
+    SECTION("exceptions are propagated to the consumer")
+    {
+        auto gen = throwing();
+        auto iter = gen.begin();
+        CHECK(*iter == "first");
+        bool thrown = false;
+        try {
+            ++iter;
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+}
@@ -16,6 +16,13 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *****************************************************************************/
 
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
 #include <radix/geometry.h>
 
 #include <catch2/catch_approx.hpp>
@@ -265,3 +272,255 @@ TEST_CASE("radix/geometry")
         CHECK(!clipped_triangles.empty());
     }
 }
+
+TEST_CASE("radix/geometry: allocation free polygon clipping")
+{
+    const auto area = [](const std::vector<geometry::Triangle<3, double>>& triangles) {
+        double sum = 0;
+        for (const auto& t : triangles)
+            sum += 0.5 * glm::length(glm::cross(t[1] - t[0], t[2] - t[0]));
+        return sum;
+    };
+    const auto triangle = geometry::Triangle<3, double> { glm::dvec3(0.0, 0.0, 0.0), glm::dvec3(10.0, 0.0, 0.0), glm::dvec3(0.0, 10.0, 0.0) };
+
+    SECTION("single plane")
+    {
+        const auto inside = geometry::clip(geometry::Polygon<3, double, 4>(triangle), geometry::Plane<double> { glm::normalize(glm::dvec3 { -1.0, -1.0, -1.0 }), 100 });
+        REQUIRE(inside.size == 3);
+        CHECK(inside[0] == triangle[0]);
+        CHECK(inside[1] == triangle[1]);
+        CHECK(inside[2] == triangle[2]);
+
+        const auto outside = geometry::clip(geometry::Polygon<3, double, 4>(triangle), geometry::Plane<double> { glm::normalize(glm::dvec3 { -1.0, -1.0, -1.0 }), -std::sqrt(3) });
+        CHECK(outside.empty());
+
+        const auto plane = geometry::Plane<double> { glm::normalize(glm::dvec3 { 1.0, 1.0, 1.0 }), -std::sqrt(3) };
+        const auto quad = geometry::clip(geometry::Polygon<3, double, 4>(triangle), plane);
+        CHECK(quad.size == 4);
+        std::vector<geometry::Triangle<3, double>> triangles;
+        geometry::triangulise(quad, std::back_inserter(triangles));
+        CHECK(triangles.size() == 2);
+        CHECK(area(triangles) == Approx(area(geometry::clip(triangle, plane))));
+        for (const auto& t : triangles)
+            CHECK(equals(geometry::normal(t), geometry::normal(triangle)));
+    }
+
+    SECTION("box against several planes gives the same geometry as the vector based clipping")
+    {
+        const auto planes = std::array {
+            geometry::Plane<double> { glm::normalize(glm::dvec3 { 1.0, 1.0, 1.0 }), -std::sqrt(3) },
+            geometry::Plane<double> { glm::normalize(glm::dvec3 { -1.0, 0.2, 0.0 }), 6 },
+            geometry::Plane<double> { glm::normalize(glm::dvec3 { 0.0, -1.0, 0.3 }), 8 },
+            geometry::Plane<double> { glm::normalize(glm::dvec3 { 0.1, 0.0, -1.0 }), 9 },
+        };
+        const auto box = geometry::Aabb<3, double> { .min = { 0.0, -1.0, -2.0 }, .max = { 10.0, 11.0, 12.0 } };
+        const auto triangles = geometry::triangulise(box);
+        const auto reference = geometry::clip(triangles, planes);
+
+        std::vector<geometry::Triangle<3, double>> clipped;
+        clipped.reserve(64);
+        geometry::clip(std::span<const geometry::Triangle<3, double>>(triangles), planes, std::back_inserter(clipped));
+        REQUIRE(!clipped.empty());
+        CHECK(area(clipped) == Approx(area(reference)));
+        for (const auto& t : clipped) {
+            for (const auto& v : t) {
+                for (const auto& plane : planes)
+                    CHECK(geometry::distance(plane, v) > -0.000001);
+            }
+        }
+    }
+
+    SECTION("the polygon capacity follows the number of planes")
+    {
+        // e.g., a frustum plus a near terrain plane. the planes are tangent to a circle inside the triangle, each of them
+        // cuts off a corner, which gives the maximum of 3 + 7 vertices.
+        const auto centre = glm::dvec3(2.93, 2.93, 0.0); // incircle, radius 2.93
+        const auto make_plane = [&](double degrees) {
+            const auto outwards = glm::dvec3(std::cos(glm::radians(degrees)), std::sin(glm::radians(degrees)), 0.0);
+            return geometry::Plane<double> { -outwards, 2.75 + glm::dot(outwards, centre) };
+        };
+        const auto planes = std::array { make_plane(20), make_plane(70), make_plane(110), make_plane(150), make_plane(210), make_plane(250), make_plane(320) };
+        CHECK(geometry::clip(geometry::Polygon<3, double, 10>(triangle), planes).size == 10);
+
+        const auto triangles = std::vector { triangle };
+        const auto reference = geometry::clip(triangles, planes);
+        REQUIRE(!reference.empty());
+
+        std::vector<geometry::Triangle<3, double>> clipped;
+        geometry::clip(std::span<const geometry::Triangle<3, double>>(triangles), planes, std::back_inserter(clipped));
+        CHECK(area(clipped) == Approx(area(reference)));
+
+        const auto plane_vector = std::vector(planes.begin(), planes.end());
+        clipped.clear();
+        geometry::clip<10>(std::span<const geometry::Triangle<3, double>>(triangles), plane_vector, std::back_inserter(clipped));
+        CHECK(area(clipped) == Approx(area(reference)));
+        CHECK_THROWS_AS(geometry::clip<9>(std::span<const geometry::Triangle<3, double>>(triangles), plane_vector, std::back_inserter(clipped)), std::length_error);
+    }
+}
+
+namespace {
+struct TestCamera {
+    glm::dvec3 position;
+    glm::dvec3 look_at;
+    double near_plane = 1.0;
+    double tan_half_fov = std::tan(glm::radians(30.0));
+
+    [[nodiscard]] glm::dmat4 view_projection() const
+    {
+        return glm::perspective(glm::radians(60.0), 1.0, near_plane, 10000.0) * glm::lookAt(position, look_at, glm::dvec3(0, 0, 1));
+    }
+
+    // ray casting reference for projected_area, counts samples on a regular grid in normalised device coordinates
+    [[nodiscard]] double raycast_area(const geometry::Aabb3d& box, int n_samples = 400) const
+    {
+        const auto f = glm::normalize(look_at - position);
+        const auto s = glm::normalize(glm::cross(f, glm::dvec3(0, 0, 1)));
+        const auto u = glm::cross(s, f);
+        int hits = 0;
+        for (int j = 0; j < n_samples; ++j) {
+            for (int i = 0; i < n_samples; ++i) {
+                const auto ndc = glm::dvec2((i + 0.5) / n_samples * 2 - 1, (j + 0.5) / n_samples * 2 - 1);
+                // direction scaled such that the parameter is the distance along the view direction
+                const auto direction = s * (ndc.x * tan_half_fov) + u * (ndc.y * tan_half_fov) + f;
+                double t_min = near_plane;
+                double t_max = std::numeric_limits<double>::max();
+                for (int d = 0; d < 3; ++d) {
+                    if (direction[d] == 0) {
+                        if (position[d] < box.min[d] || position[d] > box.max[d])
+                            t_max = -1;
+                        continue;
+                    }
+                    const auto t0 = (box.min[d] - position[d]) / direction[d];
+                    const auto t1 = (box.max[d] - position[d]) / direction[d];
+                    t_min = std::max(t_min, std::min(t0, t1));
+                    t_max = std::min(t_max, std::max(t0, t1));
+                }
+                hits += t_min <= t_max;
+            }
+        }
+        return 4.0 * hits / (n_samples * n_samples);
+    }
+};
+} // namespace
+
+TEST_CASE("radix/geometry: projected area")
+{
+    SECTION("orthographic (identity matrix)")
+    {
+        const auto m = glm::dmat4(1.0);
+        CHECK(geometry::projected_area(geometry::Aabb3d { { -0.5, -0.5, -0.5 }, { 0.5, 0.5, 0.5 } }, m) == Approx(1.0));
+        CHECK(geometry::projected_area(geometry::Aabb3d { { 0.5, -0.5, -0.5 }, { 1.5, 0.5, 0.5 } }, m) == Approx(0.5));
+        CHECK(geometry::projected_area(geometry::Aabb3d { { -2.0, -3.0, -0.5 }, { 2.0, 2.0, 0.5 } }, m) == Approx(4.0));
+        CHECK(geometry::projected_area(geometry::Aabb3d { { 2.0, -0.5, -0.5 }, { 3.0, 0.5, 0.5 } }, m) == Approx(0.0));
+        // completely in front of the near plane (z < -w)
+        CHECK(geometry::projected_area(geometry::Aabb3d { { -0.5, -0.5, -3.0 }, { 0.5, 0.5, -2.0 } }, m) == Approx(0.0));
+    }
+
+    SECTION("perspective, compared to ray casting")
+    {
+        const auto check = [](const TestCamera& camera, const geometry::Aabb3d& box) {
+            const auto area = geometry::projected_area(box, camera.view_projection());
+            CHECK(area == Approx(camera.raycast_area(box)).margin(0.02));
+            CHECK(geometry::projected_area_bound(box, camera.view_projection()) >= area - 0.000001);
+        };
+        const auto camera = TestCamera { { -20.0, -30.0, 25.0 }, { 0.0, 0.0, 0.0 } };
+        check(camera, { { -5.0, -5.0, -5.0 }, { 5.0, 5.0, 5.0 } }); // 3 faces visible
+        check(camera, { { -5.0, -5.0, -5.0 }, { 50.0, 5.0, 5.0 } }); // partially outside of the viewport
+        check(camera, { { -20.5, -29.5, 23.0 }, { -18.0, -28.5, 24.5 } }); // crosses the near plane
+        check(camera, { { -100.0, -100.0, -1.0 }, { 100.0, 100.0, 0.0 } }); // large flat tile
+        check(camera, { { 20.0, 30.0, -25.0 }, { 25.0, 35.0, -20.0 } }); // behind the look at point
+        check(camera, { { -60.0, -80.0, 20.0 }, { -50.0, -70.0, 30.0 } }); // behind the camera
+        check(camera, { { -21.0, -31.0, 24.0 }, { -19.0, -29.0, 26.0 } }); // camera inside, near plane cuts through the box
+        check(TestCamera { { 0.0, -50.0, 0.0 }, { 0.0, 0.0, 0.0 } }, { { -5.0, -5.0, -5.0 }, { 5.0, 5.0, 5.0 } }); // single face
+    }
+}
+
+namespace {
+template <glm::length_t n_dims, typename T>
+std::vector<glm::vec<n_dims, T>> random_points(size_t n, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<T> distribution(-1000, 1000);
+    std::vector<glm::vec<n_dims, T>> points(n);
+    for (auto& point : points) {
+        for (glm::length_t d = 0; d < n_dims; ++d)
+            point[d] = distribution(rng);
+    }
+    return points;
+}
+
+template <glm::length_t n_dims, typename T>
+geometry::Aabb<n_dims, T> reference_bounds(std::span<const glm::vec<n_dims, T>> points)
+{
+    geometry::Aabb<n_dims, T> bounds;
+    for (const auto& point : points)
+        bounds.expand_by(point);
+    return bounds;
+}
+
+template <glm::length_t n_dims, typename T>
+void check_find_bounds()
+{
+    for (const auto n : { 0, 1, 3, 4, 7, 8, 9, 1003 }) {
+        auto points = random_points<n_dims, T>(size_t(n), unsigned(n));
+        if (n > 5) {
+            points[2][0] = std::numeric_limits<T>::quiet_NaN();
+            points[5][n_dims - 1] = std::numeric_limits<T>::quiet_NaN();
+        }
+        const auto span = std::span<const glm::vec<n_dims, T>>(points);
+        const auto reference = reference_bounds(span);
+        CHECK(geometry::find_bounds(span) == reference);
+        CHECK(geometry::find_bounds(span, 3) == reference);
+        // remainders of the simd part
+        if (n > 3)
+            CHECK(geometry::find_bounds(span.subspan(1)) == reference_bounds(span.subspan(1)));
+    }
+}
+} // namespace
+
+TEST_CASE("radix/geometry: find_bounds")
+{
+    SECTION("float 3d") { check_find_bounds<3, float>(); }
+    SECTION("float 2d") { check_find_bounds<2, float>(); }
+    SECTION("double 3d") { check_find_bounds<3, double>(); }
+    SECTION("double 4d") { check_find_bounds<4, double>(); }
+    SECTION("int (scalar)")
+    {
+        const auto points = std::vector<glm::ivec2> { { 1, 2 }, { -3, 4 }, { 5, -6 } };
+        CHECK(geometry::find_bounds(std::span<const glm::ivec2>(points)) == geometry::Aabb<2, int> { { -3, -6 }, { 5, 4 } });
+    }
+    SECTION("multi threaded, large")
+    {
+        const auto points = random_points<3, float>(1'000'003, 42);
+        const auto span = std::span<const glm::vec3>(points);
+        const auto reference = reference_bounds(span);
+        for (const auto n_threads : { 0u, 1u, 2u, 7u, 16u })
+            CHECK(geometry::find_bounds(span, n_threads) == reference);
+    }
+}
+
+TEST_CASE("radix/geometry: find_bounds performance")
+{
+    const auto points = random_points<3, float>(10'000'000, 43);
+    const auto span = std::span<const glm::vec3>(points);
+    const auto n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    BENCHMARK("expand_by loop (1e6 points)") { return reference_bounds(span.first(1'000'000)); };
+    BENCHMARK("find_bounds (1e6 points)") { return geometry::find_bounds(span.first(1'000'000)); };
+    BENCHMARK("find_bounds multi threaded (1e6 points)") { return geometry::find_bounds(span.first(1'000'000), n_threads); };
+    BENCHMARK("expand_by loop (1e7 points)") { return reference_bounds(span); };
+    BENCHMARK("find_bounds (1e7 points)") { return geometry::find_bounds(span); };
+    BENCHMARK("find_bounds multi threaded (1e7 points)") { return geometry::find_bounds(span, n_threads); };
+}
+
+// 1.2 GB of points, run explicitly with "[find_bounds_1e8]"
+TEST_CASE("radix/geometry: find_bounds performance (1e8 points)", "[.][find_bounds_1e8]")
+{
+    const auto points = std::vector<glm::vec3>(100'000'000, glm::vec3(1, 2, 3));
+    const auto span = std::span<const glm::vec3>(points);
+    const auto n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    BENCHMARK("expand_by loop (1e8 points)") { return reference_bounds(span); };
+    BENCHMARK("find_bounds (1e8 points)") { return geometry::find_bounds(span); };
+    BENCHMARK("find_bounds multi threaded (1e8 points)") { return geometry::find_bounds(span, n_threads); };
+}
@@ -0,0 +1,253 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <memory>
+#include <random>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <radix/geometry_batch.h>
+
+using Catch::Approx;
+using namespace radix;
+
+namespace {
+template <typename T>
+std::vector<geometry::Aabb<3, T>> random_boxes(size_t n, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<T> position(-100, 100);
+    std::uniform_real_distribution<T> extent(0, 20);
+    std::vector<geometry::Aabb<3, T>> boxes;
+    for (size_t i = 0; i < n; ++i) {
+        const auto min = glm::vec<3, T>(position(rng), position(rng), position(rng));
+        boxes.push_back({ min, min + glm::vec<3, T>(extent(rng), extent(rng), extent(rng)) });
+    }
+    return boxes;
+}
+
+template <typename T>
+geometry::Frustum<T> test_frustum()
+{
+    // a slanted box shaped region, which is enough for testing (the kernels don't care about the shape)
+    using Vec = glm::vec<3, T>;
+    return {
+        geometry::Plane<T> { glm::normalize(Vec(1, 0.2, 0)), T(50) },
+        geometry::Plane<T> { glm::normalize(Vec(-1, 0.1, 0)), T(40) },
+        geometry::Plane<T> { glm::normalize(Vec(0, 1, -0.3)), T(30) },
+        geometry::Plane<T> { glm::normalize(Vec(0, -1, 0)), T(60) },
+        geometry::Plane<T> { glm::normalize(Vec(0.1, 0, 1)), T(20) },
+        geometry::Plane<T> { glm::normalize(Vec(0, 0, -1)), T(70) },
+    };
+}
+} // namespace
+
+TEST_CASE("radix/geometry_batch: AabbBatch")
+{
+    const auto boxes = random_boxes<double>(10, 1);
+    const auto batch = geometry::AabbBatch<3, double>(std::span(boxes));
+    REQUIRE(batch.size() == boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i)
+        CHECK(batch[i] == boxes[i]);
+}
+
+TEST_CASE("radix/geometry_batch: bulk operations match the scalar versions")
+{
+    const auto check = []<typename T>(T) {
+        const auto boxes = random_boxes<T>(1005, 6);
+        const auto batch = geometry::AabbBatch<3, T>(std::span(boxes));
+        const auto query_box = geometry::Aabb<3, T> { { -20, -30, -10 }, { 10, 0, 40 } };
+        const auto point = glm::vec<3, T>(5, -7, 3);
+
+        std::vector<char> expected(boxes.size());
+        std::unique_ptr<bool[]> result(new bool[boxes.size()]);
+        geometry::intersect(batch, query_box, std::span(result.get(), boxes.size()));
+        size_t n_intersecting = 0;
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            CHECK(result[i] == geometry::intersect(boxes[i], query_box));
+            n_intersecting += result[i];
+        }
+        CHECK(n_intersecting > 0);
+
+        // boxes containing the query point are rare in random data, use one of the corners as well (max is exclusive)
+        for (const auto& p : { point, boxes[3].min, boxes[4].max }) {
+            geometry::contains(batch, p, std::span(result.get(), boxes.size()));
+            for (size_t i = 0; i < boxes.size(); ++i)
+                CHECK(result[i] == boxes[i].contains(p));
+        }
+        geometry::contains(batch, boxes[3].min, std::span(result.get(), boxes.size()));
+        CHECK(result[3]);
+
+        std::vector<T> distances(boxes.size());
+        geometry::distance_sq(batch, point, std::span(distances));
+        for (size_t i = 0; i < boxes.size(); ++i)
+            CHECK(distances[i] == Approx(geometry::distance_sq(boxes[i], point)));
+
+        geometry::Aabb<3, T> bounds;
+        for (const auto& box : boxes)
+            bounds.expand_by(box);
+        CHECK(geometry::find_bounds(batch) == bounds);
+        // fewer boxes than the simd width
+        auto small_bounds = boxes[0];
+        small_bounds.expand_by(boxes[1]);
+        CHECK(geometry::find_bounds(geometry::AabbBatch<3, T>(std::span(boxes).first(2))) == small_bounds);
+        CHECK(geometry::find_bounds(geometry::AabbBatch<3, T>()) == geometry::Aabb<3, T>());
+    };
+    SECTION("double") { check(double {}); }
+    SECTION("float") { check(float {}); }
+    SECTION("2d int (scalar fallback)")
+    {
+        auto batch = geometry::AabbBatch<2, int>();
+        batch.push_back({ { 0, 0 }, { 10, 10 } });
+        batch.push_back({ { 20, 0 }, { 30, 10 } });
+        std::array<bool, 2> result = {};
+        geometry::intersect(batch, geometry::Aabb<2, int> { { 5, 5 }, { 20, 6 } }, std::span<bool>(result));
+        CHECK(result == std::array { true, true });
+        geometry::contains(batch, glm::ivec2(10, 5), std::span<bool>(result));
+        CHECK(result == std::array { false, false });
+        std::array<int, 2> distances = {};
+        geometry::distance_sq(batch, glm::ivec2(13, 14), std::span<int>(distances));
+        CHECK(distances == std::array { 9 + 16, 49 + 16 });
+        CHECK(geometry::find_bounds(batch) == geometry::Aabb<2, int> { { 0, 0 }, { 30, 10 } });
+    }
+}
+
+TEST_CASE("radix/geometry_batch: classify against frustum")
+{
+    SECTION("scalar")
+    {
+        const auto planes = test_frustum<double>();
+        CHECK(geometry::classify(geometry::Aabb3d { { -1, -1, -1 }, { 1, 1, 1 } }, planes) == geometry::Classification::Inside);
+        CHECK(geometry::classify(geometry::Aabb3d { { -100, -1, -1 }, { 1, 1, 1 } }, planes) == geometry::Classification::Intersecting);
+        CHECK(geometry::classify(geometry::Aabb3d { { -200, -1, -1 }, { -100, 1, 1 } }, planes) == geometry::Classification::Outside);
+    }
+    SECTION("batch double matches scalar")
+    {
+        const auto boxes = random_boxes<double>(1001, 2);
+        const auto planes = test_frustum<double>();
+        const auto batch = geometry::AabbBatch<3, double>(std::span(boxes));
+        std::vector<geometry::Classification> result(batch.size());
+        geometry::classify(batch, planes, std::span(result));
+        std::array<unsigned, 3> counts = {};
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            CHECK(result[i] == geometry::classify(boxes[i], planes));
+            counts[unsigned(result[i])]++;
+        }
+        // make sure the test data covers all cases
+        CHECK(counts[0] > 0);
+        CHECK(counts[1] > 0);
+        CHECK(counts[2] > 0);
+    }
+    SECTION("batch float matches scalar")
+    {
+        const auto boxes = random_boxes<float>(1003, 3);
+        const auto planes = test_frustum<float>();
+        const auto batch = geometry::AabbBatch<3, float>(std::span(boxes));
+        std::vector<geometry::Classification> result(batch.size());
+        geometry::classify(batch, planes, std::span(result));
+        for (size_t i = 0; i < boxes.size(); ++i)
+            CHECK(result[i] == geometry::classify(boxes[i], planes));
+    }
+}
+
+TEST_CASE("radix/geometry_batch: projected area bound")
+{
+    const auto check = []<typename T>(T) {
+        const auto boxes = random_boxes<T>(1003, 4);
+        const auto view_projection = glm::perspective(glm::radians(T(60)), T(1.5), T(1), T(1000))
+            * glm::lookAt(glm::vec<3, T>(-150, -50, 20), glm::vec<3, T>(0, 0, 0), glm::vec<3, T>(0, 0, 1));
+        const auto batch = geometry::AabbBatch<3, T>(std::span(boxes));
+        std::vector<T> areas(boxes.size());
+        geometry::projected_area_bound(batch, view_projection, std::span(areas));
+        size_t n_visible = 0;
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            CHECK(areas[i] == Approx(geometry::projected_area_bound(boxes[i], view_projection)).scale(1));
+            CHECK(areas[i] >= geometry::projected_area(boxes[i], view_projection) - T(0.0001));
+            n_visible += areas[i] > 0;
+        }
+        CHECK(n_visible > 10);
+        CHECK(n_visible < boxes.size());
+    };
+    SECTION("double") { check(double {}); }
+    SECTION("float") { check(float {}); }
+}
+
+TEST_CASE("radix/geometry_batch: classify performance")
+{
+    const auto boxes = random_boxes<float>(100'000, 4);
+    const auto planes = test_frustum<float>();
+    const auto batch = geometry::AabbBatch<3, float>(std::span(boxes));
+    std::vector<geometry::Classification> result(batch.size());
+
+    BENCHMARK("scalar classify (100k boxes)")
+    {
+        unsigned n_visible = 0;
+        for (const auto& box : boxes)
+            n_visible += geometry::classify(box, planes) != geometry::Classification::Outside;
+        return n_visible;
+    };
+    BENCHMARK("batch classify (100k boxes)")
+    {
+        geometry::classify(batch, planes, std::span(result));
+        return result.back();
+    };
+}
+
+TEST_CASE("radix/geometry_batch: projected area performance")
+{
+    const auto boxes = random_boxes<float>(100'000, 5);
+    const auto view_projection = glm::perspective(glm::radians(60.f), 1.5f, 1.f, 1000.f)
+        * glm::lookAt(glm::vec3(-150, -50, 20), glm::vec3(0, 0, 0), glm::vec3(0, 0, 1));
+    const auto batch = geometry::AabbBatch<3, float>(std::span(boxes));
+    std::vector<float> areas(batch.size());
+
+    BENCHMARK("scalar projected_area (100k boxes)")
+    {
+        float sum = 0;
+        for (const auto& box : boxes)
+            sum += geometry::projected_area(box, view_projection);
+        return sum;
+    };
+    BENCHMARK("batch projected_area_bound (100k boxes)")
+    {
+        geometry::projected_area_bound(batch, view_projection, std::span(areas));
+        return areas.back();
+    };
+}
+
+TEST_CASE("radix/geometry_batch: distance_sq performance")
+{
+    const auto boxes = random_boxes<double>(100'000, 7);
+    const auto batch = geometry::AabbBatch<3, double>(std::span(boxes));
+    const auto point = glm::dvec3(5, -7, 3);
+    std::vector<double> distances(batch.size());
+
+    BENCHMARK("scalar distance_sq (100k boxes)")
+    {
+        for (size_t i = 0; i < boxes.size(); ++i)
+            distances[i] = geometry::distance_sq(boxes[i], point);
+        return distances.back();
+    };
+    BENCHMARK("batch distance_sq (100k boxes)")
+    {
+        geometry::distance_sq(batch, point, std::span(distances));
+        return distances.back();
+    };
+}
@@ -16,6 +16,15 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *****************************************************************************/
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <radix/height_encoding.h>
@@ -73,3 +82,173 @@ TEST_CASE("radix/height encoding round trip")
     for (auto v : test_cases)
         CHECK(to_float(to_rgb(v)) == Catch::Approx(v));
 }
+
+namespace {
+std::vector<radix::height_encoding::Implementation> supported_implementations()
+{
+    using radix::height_encoding::Implementation;
+    std::vector<Implementation> implementations;
+    for (const auto implementation : { Implementation::Scalar, Implementation::Sse41, Implementation::Avx2 }) {
+        if (radix::height_encoding::is_supported(implementation))
+            implementations.push_back(implementation);
+    }
+    return implementations;
+}
+} // namespace
+
+TEST_CASE("radix/height encoding span kernels")
+{
+    using namespace radix::height_encoding;
+
+    SECTION("encode is bit identical to to_rgb")
+    {
+        // around every rounding tie, and some values outside of the range
+        constexpr float factor = 65535.f / (max_height - min_height);
+        std::vector<float> heights;
+        for (unsigned k = 0; k < 65536; ++k) {
+            const auto tie = (float(k) + 0.5f) / factor;
+            heights.push_back(tie);
+            heights.push_back(std::nextafter(tie, 0.f));
+            heights.push_back(std::nextafter(tie, 10'000.f));
+        }
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<float> height(-9000.f, 20'000.f);
+        for (int i = 0; i < 10'003; ++i)
+            heights.push_back(height(rng));
+        heights.push_back(-0.f);
+        heights.push_back(-0.5f / factor);
+
+        for (const auto implementation : supported_implementations()) {
+            std::vector<glm::u8vec3> rgb(heights.size());
+            encode(heights, rgb, implementation);
+            size_t n_different = 0;
+            for (size_t i = 0; i < heights.size(); ++i)
+                n_different += rgb[i] != to_rgb(heights[i]);
+            CHECK(n_different == 0);
+        }
+    }
+
+    SECTION("decode is bit identical to to_float")
+    {
+        std::vector<glm::u8vec3> rgb;
+        for (unsigned r = 0; r < 256; ++r) {
+            for (unsigned g = 0; g < 256; ++g)
+                rgb.emplace_back(r, g, (r * g) & 255);
+        }
+        rgb.emplace_back(1, 2, 3); // not a multiple of the simd width
+        for (const auto implementation : supported_implementations()) {
+            std::vector<float> heights(rgb.size());
+            decode(rgb, heights, implementation);
+            size_t n_different = 0;
+            for (size_t i = 0; i < rgb.size(); ++i)
+                n_different += std::bit_cast<uint32_t>(heights[i]) != std::bit_cast<uint32_t>(to_float(rgb[i]));
+            CHECK(n_different == 0);
+        }
+    }
+
+    SECTION("default implementation")
+    {
+        CHECK(is_supported(best_implementation()));
+        const auto heights = std::vector<float> { 0.f, 1.f, 50.f, 122.f, 1234.f, 2495.f, 3798.f, 8191.25f, 42.f };
+        std::vector<glm::u8vec3> rgb(heights.size());
+        encode(heights, rgb);
+        std::vector<float> decoded(heights.size());
+        decode(rgb, decoded);
+        for (size_t i = 0; i < heights.size(); ++i)
+            CHECK(decoded[i] == Catch::Approx(heights[i]));
+    }
+}
+
+TEST_CASE("radix/height encoding fused decode and min / max")
+{
+    using namespace radix::height_encoding;
+    const auto check = [](const std::vector<glm::u8vec3>& rgb) {
+        std::vector<float> expected(rgb.size());
+        decode(rgb, expected, Implementation::Scalar);
+        const auto [expected_min, expected_max] = std::minmax_element(expected.begin(), expected.end());
+
+        for (const auto implementation : supported_implementations()) {
+            std::vector<float> heights(rgb.size());
+            const auto min_max = decode_min_max(rgb, heights, implementation);
+            CHECK(min_max.first == *expected_min);
+            CHECK(min_max.second == *expected_max);
+            CHECK(heights == expected);
+            CHECK(decode_min_max(rgb, {}, implementation) == min_max);
+        }
+    };
+
+    SECTION("single pixel")
+    {
+        check({ glm::u8vec3(12, 34, 0) });
+    }
+
+    SECTION("extremes in the first simd lane and in the scalar tail")
+    {
+        std::mt19937 rng(2);
+        std::uniform_int_distribution<unsigned> byte(0, 255);
+        for (const auto size : { size_t(5), size_t(9), size_t(17), size_t(65 * 65), size_t(256 * 256) }) {
+            std::vector<glm::u8vec3> rgb(size);
+            for (auto& v : rgb)
+                v = glm::u8vec3(byte(rng) / 4 + 60, byte(rng), 0);
+            rgb[0] = { 0, 3, 0 };
+            rgb[size - 1] = { 255, 255, 0 };
+            check(rgb);
+        }
+    }
+}
+
+TEST_CASE("radix/height encoding performance")
+{
+    using namespace radix::height_encoding;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> height(0.f, 4000.f);
+    std::vector<float> heights(256 * 256);
+    for (auto& h : heights)
+        h = height(rng);
+    std::vector<glm::u8vec3> rgb(heights.size());
+
+    BENCHMARK("to_rgb loop (256x256)")
+    {
+        for (size_t i = 0; i < heights.size(); ++i)
+            rgb[i] = to_rgb(heights[i]);
+        return rgb.back();
+    };
+    for (const auto implementation : supported_implementations()) {
+        const auto name = std::string("encode, implementation ") + std::to_string(int(implementation)) + " (256x256)";
+        BENCHMARK(name.c_str())
+        {
+            encode(heights, rgb, implementation);
+            return rgb.back();
+        };
+    }
+    BENCHMARK("to_float loop (256x256)")
+    {
+        for (size_t i = 0; i < heights.size(); ++i)
+            heights[i] = to_float(rgb[i]);
+        return heights.back();
+    };
+    for (const auto implementation : supported_implementations()) {
+        const auto name = std::string("decode, implementation ") + std::to_string(int(implementation)) + " (256x256)";
+        BENCHMARK(name.c_str())
+        {
+            decode(rgb, heights, implementation);
+            return heights.back();
+        };
+    }
+    BENCHMARK("decode and std::minmax_element (256x256)")
+    {
+        decode(rgb, heights);
+        const auto [min, max] = std::minmax_element(heights.begin(), heights.end());
+        return *max - *min;
+    };
+    BENCHMARK("decode_min_max (256x256)")
+    {
+        const auto [min, max] = decode_min_max(rgb, heights);
+        return max - min;
+    };
+    BENCHMARK("decode_min_max without output (256x256)")
+    {
+        const auto [min, max] = decode_min_max(rgb, {});
+        return max - min;
+    };
+}
@@ -0,0 +1,205 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <cmath>
+#include <memory>
+#include <random>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <radix/HorizonCuller.h>
+
+using namespace radix;
+
+namespace {
+// true if every segment from the camera to sample points on the box passes through the solid part of an occluder
+bool brute_force_hidden(const glm::dvec3& camera, const std::vector<geometry::Aabb3d>& occluders, const geometry::Aabb3d& box)
+{
+    constexpr int n = 6;
+    for (int i = 0; i <= n; ++i) {
+        for (int j = 0; j <= n; ++j) {
+            for (int k = 0; k <= n; ++k) {
+                if (i % n && j % n && k % n)
+                    continue; // only points on the surface
+                const auto point = box.min + box.size() * glm::dvec3(i, j, k) / double(n);
+                const auto ray = geometry::Line<3, double> { camera, point - camera };
+                const auto blocked = std::any_of(occluders.begin(), occluders.end(), [&](const geometry::Aabb3d& occluder) {
+                    const auto solid = geometry::Aabb3d { { occluder.min.x, occluder.min.y, -1'000'000.0 }, { occluder.max.x, occluder.max.y, occluder.min.z } };
+                    const auto interval = geometry::ray_intersection(ray, solid);
+                    return interval && interval->first < 1.0;
+                });
+                if (!blocked)
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+} // namespace
+
+TEST_CASE("radix/HorizonCuller")
+{
+    SECTION("wall")
+    {
+        HorizonCuller culler({ 0.0, 0.0, 10.0 }, 256);
+        culler.add_occluder({ { 100.0, -100.0, 50.0 }, { 110.0, 100.0, 60.0 } });
+        CHECK(culler.is_hidden({ { 200.0, -5.0, 0.0 }, { 210.0, 5.0, 40.0 } }));
+        CHECK(!culler.is_hidden({ { 200.0, -5.0, 0.0 }, { 210.0, 5.0, 100.0 } })); // peeks over the wall
+        CHECK(!culler.is_hidden({ { 50.0, -5.0, 0.0 }, { 60.0, 5.0, 20.0 } })); // in front of the wall
+        CHECK(!culler.is_hidden({ { 200.0, 500.0, 0.0 }, { 210.0, 510.0, 20.0 } })); // beside the wall
+        CHECK(!culler.is_hidden({ { -210.0, -5.0, 0.0 }, { -200.0, 5.0, 20.0 } })); // behind the camera
+        CHECK(!culler.is_hidden({ { -5.0, -5.0, 0.0 }, { 5.0, 5.0, 20.0 } })); // below the camera
+
+        // the wall crosses the azimuth 0 / 2 pi
+        bool hidden = false;
+        culler.is_hidden(std::span<const geometry::Aabb3d>(std::array { geometry::Aabb3d { { 200.0, -50.0, 0.0 }, { 210.0, 50.0, 20.0 } } }), std::span(&hidden, 1));
+        CHECK(hidden);
+
+        // batched, including boxes around the camera
+        const auto boxes = std::vector<geometry::Aabb3d> { { { 200.0, -5.0, 0.0 }, { 210.0, 5.0, 40.0 } }, { { 200.0, -5.0, 0.0 }, { 210.0, 5.0, 100.0 } },
+            { { 50.0, -5.0, 0.0 }, { 60.0, 5.0, 20.0 } }, { { 200.0, 500.0, 0.0 }, { 210.0, 510.0, 20.0 } }, { { -210.0, -5.0, 0.0 }, { -200.0, 5.0, 20.0 } },
+            { { -5.0, -5.0, 0.0 }, { 5.0, 5.0, 20.0 } }, { { 0.0, 0.0, 0.0 }, { 5.0, 5.0, 20.0 } }, { { 200.0, -50.0, 0.0 }, { 210.0, 50.0, 20.0 } },
+            { { 300.0, -50.0, 0.0 }, { 310.0, 50.0, 20.0 } } };
+        std::unique_ptr<bool[]> batch_hidden(new bool[boxes.size()]);
+        culler.is_hidden(boxes, std::span(batch_hidden.get(), boxes.size()));
+        for (size_t i = 0; i < boxes.size(); ++i)
+            CHECK(batch_hidden[i] == culler.is_hidden(boxes[i]));
+    }
+
+    SECTION("staircase stays sorted and minimal")
+    {
+        HorizonCuller culler({ 0.0, 0.0, 0.0 }, 8);
+        culler.add_occluder({ { 100.0, -1000.0, 10.0 }, { 200.0, 1000.0, 20.0 } });
+        culler.add_occluder({ { 300.0, -1000.0, 5.0 }, { 400.0, 1000.0, 20.0 } }); // lower, further away, dominated
+        culler.add_occluder({ { 50.0, -1000.0, 10.0 }, { 60.0, 1000.0, 20.0 } }); // same height, closer: dominates the first
+        for (unsigned bin = 0; bin < culler.n_bins(); ++bin) {
+            const auto& steps = culler.steps(bin);
+            for (size_t i = 1; i < steps.size(); ++i) {
+                CHECK(steps[i - 1].distance < steps[i].distance);
+                CHECK(steps[i - 1].slope < steps[i].slope);
+            }
+        }
+        // the occluders cover azimuths between about -84 and 84 degrees, i.e., bins 0 and 7 (45 degrees each) completely
+        CHECK(culler.steps(0).size() == 1);
+        CHECK(culler.steps(7).size() == 1);
+        CHECK(culler.steps(1).empty());
+        CHECK(culler.steps(6).empty());
+    }
+
+    SECTION("random scenes are conservative")
+    {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<double> angle(0, 2 * glm::pi<double>());
+        std::uniform_real_distribution<double> unit(0, 1);
+        const auto camera = glm::dvec3(0.0, 0.0, 100.0);
+        const auto random_box = [&](double min_distance, double max_distance, double max_size, double max_height) {
+            const auto a = angle(rng);
+            const auto r = min_distance + unit(rng) * (max_distance - min_distance);
+            const auto min = glm::dvec3(std::cos(a) * r, std::sin(a) * r, unit(rng) * max_height);
+            return geometry::Aabb3d { min, min + glm::dvec3(unit(rng) * max_size, unit(rng) * max_size, unit(rng) * 100) };
+        };
+        std::vector<geometry::Aabb3d> occluders;
+        for (int i = 0; i < 300; ++i)
+            occluders.push_back(random_box(100, 2'000, 400, 300));
+        HorizonCuller culler(camera, 512);
+        for (const auto& occluder : occluders)
+            culler.add_occluder(occluder);
+
+        std::vector<geometry::Aabb3d> candidates;
+        for (int i = 0; i < 2000; ++i)
+            candidates.push_back(random_box(100, 5'000, 100, 300));
+        std::unique_ptr<bool[]> hidden(new bool[candidates.size()]);
+        culler.is_hidden(candidates, std::span(hidden.get(), candidates.size()));
+        size_t n_hidden = 0;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            CHECK(hidden[i] == culler.is_hidden(candidates[i]));
+            if (hidden[i]) {
+                CHECK(brute_force_hidden(camera, occluders, candidates[i]));
+                ++n_hidden;
+            }
+        }
+        CHECK(n_hidden > 100);
+    }
+
+    SECTION("occluders from TileHeights")
+    {
+        // a 2 km high ridge in the middle of a 10 km square, the camera is on the ground to the west of it
+        const auto srs_bounds = [](const tile::Id& id) {
+            const auto size = 10'000.0 / double(1u << id.zoom_level);
+            const auto min = glm::dvec2(id.coords) * size;
+            return tile::SrsBounds { min, min + glm::dvec2(size) };
+        };
+        constexpr unsigned max_zoom = 5;
+        TileHeights heights;
+        for (unsigned zoom = 0; zoom <= max_zoom; ++zoom) {
+            for (unsigned y = 0; y < (1u << zoom); ++y) {
+                for (unsigned x = 0; x < (1u << zoom); ++x) {
+                    const auto bounds = srs_bounds({ zoom, { x, y } });
+                    const auto on_ridge = bounds.min.x >= 4'500 && bounds.max.x <= 5'500;
+                    const auto touches_ridge = bounds.max.x > 4'500 && bounds.min.x < 5'500;
+                    heights.emplace({ zoom, { x, y } }, { on_ridge ? 2'000.f : 0.f, touches_ridge ? 2'000.f : 10.f });
+                }
+            }
+        }
+        HorizonCuller culler({ 1'000.0, 5'000.0, 20.0 }, 1024);
+        culler.add_occluders(heights, srs_bounds, max_zoom, 20'000.0);
+
+        const auto box = [&](const tile::Id& id) {
+            const auto bounds = srs_bounds(id);
+            const auto [min_height, max_height] = heights.query(id);
+            return geometry::Aabb3d { glm::dvec3(bounds.min, min_height), glm::dvec3(bounds.max, max_height) };
+        };
+        // directly behind the ridge
+        CHECK(culler.is_hidden(box({ max_zoom, { 24, 16 } })));
+        CHECK(culler.is_hidden(box({ max_zoom, { 30, 15 } })));
+        // the ridge itself and tiles in front of it are visible
+        CHECK(!culler.is_hidden(box({ max_zoom, { 15, 16 } })));
+        CHECK(!culler.is_hidden(box({ max_zoom, { 2, 16 } })));
+    }
+}
+
+TEST_CASE("radix/HorizonCuller: performance")
+{
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> coordinate(-5'000, 5'000);
+    std::uniform_real_distribution<double> unit(0, 1);
+    const auto random_box = [&](double max_size, double max_height) {
+        const auto min = glm::dvec3(coordinate(rng), coordinate(rng), unit(rng) * max_height);
+        return geometry::Aabb3d { min, min + glm::dvec3(unit(rng) * max_size, unit(rng) * max_size, unit(rng) * 100) };
+    };
+    HorizonCuller culler({ 0.0, 0.0, 100.0 }, 1024);
+    for (int i = 0; i < 1000; ++i)
+        culler.add_occluder(random_box(400, 300));
+    std::vector<geometry::Aabb3d> candidates;
+    for (int i = 0; i < 100'000; ++i)
+        candidates.push_back(random_box(100, 300));
+    std::unique_ptr<bool[]> hidden(new bool[candidates.size()]);
+
+    BENCHMARK("scalar is_hidden loop (100k boxes)")
+    {
+        for (size_t i = 0; i < candidates.size(); ++i)
+            hidden[i] = culler.is_hidden(candidates[i]);
+        return hidden[0];
+    };
+    BENCHMARK("batch is_hidden (100k boxes)")
+    {
+        culler.is_hidden(candidates, std::span(hidden.get(), candidates.size()));
+        return hidden[0];
+    };
+}
@@ -0,0 +1,72 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <radix/PredicateCache.h>
+#include <radix/quad_tree.h>
+
+using namespace radix;
+
+TEST_CASE("radix/PredicateCache")
+{
+    glm::dvec3 camera = { 0, 0, 0 };
+    const auto lod_predicate = [&camera](const tile::Id& id) {
+        // refine tiles close to the origin, distance is measured to the camera
+        const auto tile_centre = (glm::dvec2(id.coords) + 0.5) / double(1u << id.zoom_level);
+        return id.zoom_level < 8 && glm::distance(tile_centre, glm::dvec2(camera)) * double(1u << id.zoom_level) < 3.0;
+    };
+    const auto generate_children = [](const tile::Id& id) { return id.children(); };
+    const auto root = tile::Id { 0, { 0, 0 } };
+
+    const auto reference = quad_tree::onTheFlyTraverse(root, lod_predicate, generate_children);
+
+    PredicateCache cache(lod_predicate, 0.001);
+    cache.set_camera_position(camera);
+    CHECK(quad_tree::onTheFlyTraverse(root, cache.predicate(), generate_children) == reference);
+    const auto n_first_frame = cache.n_evaluations();
+    CHECK(n_first_frame > 0);
+    CHECK(cache.size() == n_first_frame);
+
+    SECTION("static camera doesn't evaluate the predicate again")
+    {
+        CHECK(quad_tree::onTheFlyTraverse(root, cache.predicate(), generate_children) == reference);
+        CHECK(cache.n_evaluations() == n_first_frame);
+    }
+    SECTION("small camera movements reuse the results")
+    {
+        camera = { 0.0005, 0.0, 0.0 };
+        cache.set_camera_position(camera);
+        quad_tree::onTheFlyTraverse(root, cache.predicate(), generate_children);
+        CHECK(cache.n_evaluations() == n_first_frame);
+    }
+    SECTION("larger camera movements evaluate the predicate again")
+    {
+        camera = { 0.5, 0.5, 0.0 };
+        cache.set_camera_position(camera);
+        const auto leaves = quad_tree::onTheFlyTraverse(root, cache.predicate(), generate_children);
+        CHECK(leaves == quad_tree::onTheFlyTraverse(root, lod_predicate, generate_children));
+        CHECK(cache.n_evaluations() > n_first_frame);
+    }
+    SECTION("prune removes stale entries")
+    {
+        cache.set_camera_position({ 10.0, 0.0, 0.0 });
+        cache.prune();
+        CHECK(cache.size() == 0);
+    }
+}
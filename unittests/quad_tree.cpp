@@ -16,8 +16,12 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *****************************************************************************/
 
+#include <functional>
+#include <stdexcept>
+
 #include <catch2/catch_test_macros.hpp>
 #include <radix/quad_tree.h>
+#include <radix/tile.h>
 
 using namespace radix;
 
@@ -343,3 +347,252 @@ TEST_CASE("radix/quad_tree: on the fly traverse")
         CHECK(std::find(leaves.begin(), leaves.end(), 11) == leaves.end());
     }
 }
+
+TEST_CASE("radix/quad_tree: lazy on the fly traverse")
+{
+    const auto generate_children_function = [](const auto& node_value) {
+        const auto t = node_value / 4;
+        const auto t2 = node_value % 4 - 1;
+        return std::array<int, 4>({ t + t2, t, t, t });
+    };
+    const auto refine_predicate = [](const auto& node_value) { return node_value > 1; };
+
+    SECTION("same leaves in the same order as the eager version")
+    {
+        for (const auto root : { 0, 1, 5, 42, 1234 }) {
+            const auto eager = quad_tree::onTheFlyTraverse(root, refine_predicate, generate_children_function);
+            std::vector<int> lazy;
+            for (const auto& leaf : quad_tree::onTheFlyTraverseLazy(root, refine_predicate, generate_children_function))
+                lazy.push_back(leaf);
+            CHECK(lazy == eager);
+        }
+    }
+    SECTION("stopping early saves predicate calls")
+    {
+        unsigned n_predicate_calls = 0;
+        const auto counting_predicate = [&](const auto& node_value) {
+            ++n_predicate_calls;
+            return node_value > 1;
+        };
+        const auto n_leaves = quad_tree::onTheFlyTraverse(1234, counting_predicate, generate_children_function).size();
+        const auto n_calls_eager = n_predicate_calls;
+        REQUIRE(n_leaves > 10);
+
+        n_predicate_calls = 0;
+        std::vector<int> first_leaves;
+        for (const auto& leaf : quad_tree::onTheFlyTraverseLazy(1234, counting_predicate, generate_children_function)) {
+            first_leaves.push_back(leaf);
+            if (first_leaves.size() == 3)
+                break;
+        }
+        CHECK(first_leaves.size() == 3);
+        CHECK(n_predicate_calls < n_calls_eager / 2);
+    }
+    SECTION("root is a leaf")
+    {
+        std::vector<int> leaves;
+        for (const auto& leaf : quad_tree::onTheFlyTraverseLazy(42, [](const auto&) { return false; }, generate_children_function))
+            leaves.push_back(leaf);
+        CHECK(leaves == std::vector({ 42 }));
+    }
+}
+
+TEST_CASE("radix/quad_tree: breadth first on the fly traverse")
+{
+    const auto generate_children_function = [](const auto& node_value) {
+        const auto t = node_value / 4;
+        const auto t2 = node_value % 4 - 1;
+        return std::array<int, 4>({ t + t2, t, t, t });
+    };
+    SECTION("same leaves as the depth first version")
+    {
+        for (const auto root : { 0, 1, 5, 42, 1234 }) {
+            auto depth_first = quad_tree::onTheFlyTraverse(root, [](const auto& v) { return v > 1; }, generate_children_function);
+            auto breadth_first = quad_tree::onTheFlyTraverseBreadthFirst(
+                root,
+                [](std::span<const int> frontier, std::span<bool> needs_refinement) {
+                    REQUIRE(frontier.size() == needs_refinement.size());
+                    std::transform(frontier.begin(), frontier.end(), needs_refinement.begin(), [](int v) { return v > 1; });
+                },
+                generate_children_function);
+            std::sort(depth_first.begin(), depth_first.end());
+            std::sort(breadth_first.begin(), breadth_first.end());
+            CHECK(depth_first == breadth_first);
+        }
+    }
+    SECTION("predicate is called once per level with the whole frontier")
+    {
+        std::vector<size_t> frontier_sizes;
+        const auto leaves = quad_tree::onTheFlyTraverseBreadthFirst(
+            0,
+            [&](std::span<const int> frontier, std::span<bool> needs_refinement) {
+                frontier_sizes.push_back(frontier.size());
+                for (size_t i = 0; i < frontier.size(); ++i)
+                    needs_refinement[i] = frontier[i] < 5;
+            },
+            [](const int& v) { return std::array<int, 4>({ v + 1, v + 1, v + 1, v + 10 }); });
+        CHECK(frontier_sizes == std::vector<size_t>({ 1, 4, 12, 36, 108, 324 }));
+        CHECK(leaves.size() == 1 + 3 + 9 + 27 + 324);
+        // leaves are ordered coarse to fine
+        CHECK(leaves.front() == 10);
+        CHECK(leaves.back() == 14);
+    }
+}
+
+TEST_CASE("radix/quad_tree: serialisation")
+{
+    const auto generate_children_function = [](const auto& node_value) {
+        return std::array<int, 4>({ node_value * 4 + 1, node_value * 4 + 2, node_value * 4 + 3, node_value * 4 + 4 });
+    };
+    quad_tree::Node<int> root(0);
+    quad_tree::refine(&root, [](const auto& v) { return v < 100 && v % 3 != 2; }, generate_children_function);
+    std::vector<int> original;
+    quad_tree::visit(&root, [&](int v) { original.push_back(v); });
+    REQUIRE(original.size() > 20);
+
+    SECTION("topology round trip")
+    {
+        const auto bytes = quad_tree::serialiseTopology(root);
+        CHECK(bytes.size() == sizeof(uint64_t) + (original.size() + 7) / 8);
+
+        quad_tree::Node<int> restored(0);
+        restored.addChildren({ -1, -1, -1, -1 }); // will be replaced
+        REQUIRE(quad_tree::restoreTopology(&restored, bytes, generate_children_function));
+        std::vector<int> restored_values;
+        quad_tree::visit(&restored, [&](int v) { restored_values.push_back(v); });
+        CHECK(restored_values == original);
+    }
+    SECTION("round trip with payload")
+    {
+        const auto bytes = quad_tree::serialise(root);
+        CHECK(bytes.size() == sizeof(uint64_t) + (original.size() + 7) / 8 + original.size() * sizeof(int));
+        auto restored = quad_tree::deserialise<int>(bytes);
+        REQUIRE(restored.has_value());
+        std::vector<int> restored_values;
+        quad_tree::visit(&restored.value(), [&](int v) { restored_values.push_back(v); });
+        CHECK(restored_values == original);
+    }
+    SECTION("single node")
+    {
+        const auto bytes = quad_tree::serialise(quad_tree::Node<int>(42));
+        const auto restored = quad_tree::deserialise<int>(bytes);
+        REQUIRE(restored.has_value());
+        CHECK(restored->data() == 42);
+        CHECK(!restored->hasChildren());
+    }
+    SECTION("malformed input is rejected")
+    {
+        auto bytes = quad_tree::serialise(root);
+        CHECK(!quad_tree::deserialise<int>(std::vector<std::byte>()).has_value());
+        CHECK(!quad_tree::deserialise<int>(std::vector<std::byte>(bytes.begin(), bytes.end() - 1)).has_value());
+
+        auto topology = quad_tree::serialiseTopology(root);
+        topology.back() = std::byte(0xff); // too many nodes with children
+        quad_tree::Node<int> restored(0);
+        CHECK(!quad_tree::restoreTopology(&restored, topology, generate_children_function));
+    }
+}
+
+TEST_CASE("radix/quad_tree: multi view on the fly traverse")
+{
+    const auto generate_children_function = [](const auto& node_value) {
+        const auto t = node_value / 4;
+        const auto t2 = node_value % 4 - 1;
+        return std::array<int, 4>({ t + t2, t, t, t });
+    };
+    std::vector<std::function<bool(const int&)>> predicates;
+    predicates.emplace_back([](const int& v) { return v > 1; });
+    predicates.emplace_back([](const int& v) { return v > 20; });
+    predicates.emplace_back([](const int&) { return false; });
+    predicates.emplace_back([](const int& v) { return v % 2 == 0 && v > 0; });
+
+    unsigned n_generate_calls = 0;
+    const auto counting_generate_children = [&](const auto& node_value) {
+        ++n_generate_calls;
+        return generate_children_function(node_value);
+    };
+    const auto leaves = quad_tree::onTheFlyTraverseMultiView(1234, predicates, counting_generate_children);
+    REQUIRE(leaves.size() == predicates.size());
+
+    unsigned n_generate_calls_single_views = 0;
+    const auto counting_generate_children_single = [&](const auto& node_value) {
+        ++n_generate_calls_single_views;
+        return generate_children_function(node_value);
+    };
+    for (size_t i = 0; i < predicates.size(); ++i)
+        CHECK(leaves[i] == quad_tree::onTheFlyTraverse(1234, predicates[i], counting_generate_children_single));
+    CHECK(n_generate_calls < n_generate_calls_single_views);
+    CHECK(leaves[2] == std::vector({ 1234 }));
+
+    SECTION("shared node data")
+    {
+        // stands in for a TileHeights / bounds lookup, which shouldn't be repeated per view
+        const auto node_data = [](const int& v) { return v / 3; };
+        std::vector<std::function<bool(const int&, const int&)>> data_predicates;
+        data_predicates.emplace_back([](const int& v, const int& d) { return v > 1 && d > 0; });
+        data_predicates.emplace_back([](const int&, const int& d) { return d > 10; });
+        data_predicates.emplace_back([](const int& v, const int& d) { return v % 2 == 0 && d > 1; });
+
+        unsigned n_lookups = 0;
+        const auto counting_node_data = [&](const int& v) {
+            ++n_lookups;
+            return node_data(v);
+        };
+        n_generate_calls = 0;
+        const auto data_leaves = quad_tree::onTheFlyTraverseMultiView(1234, counting_node_data, data_predicates, counting_generate_children);
+        REQUIRE(data_leaves.size() == data_predicates.size());
+        CHECK(n_lookups == 1 + 4 * n_generate_calls); // once per visited node
+
+        const auto n_lookups_multi_view = n_lookups;
+        n_lookups = 0;
+        for (size_t i = 0; i < data_predicates.size(); ++i) {
+            const auto predicate = [&](const int& v) { return data_predicates[i](v, counting_node_data(v)); };
+            CHECK(data_leaves[i] == quad_tree::onTheFlyTraverse(1234, predicate, generate_children_function));
+        }
+        CHECK(n_lookups_multi_view < n_lookups);
+    }
+
+    SECTION("more than 64 views are rejected")
+    {
+        std::vector<std::function<bool(const int&)>> too_many(65, [](const int&) { return false; });
+        CHECK_THROWS_AS(quad_tree::onTheFlyTraverseMultiView(1234, too_many, generate_children_function), std::length_error);
+        too_many.pop_back();
+        CHECK(quad_tree::onTheFlyTraverseMultiView(1234, too_many, generate_children_function).size() == 64);
+    }
+}
+
+TEST_CASE("radix/quad_tree: adjacent leaves")
+{
+    // finer towards the south west corner
+    quad_tree::Node<tile::Id> root({ 0, { 0, 0 } });
+    const auto refine = [](const tile::Id& id) { return id.zoom_level < 6 && id.coords.x + id.coords.y < 3u; };
+    quad_tree::refine(&root, refine, [](const tile::Id& id) { return id.children(); });
+
+    std::vector<tile::Id> leaves;
+    quad_tree::visitLeaves(&root, [&](const tile::Id& id) { leaves.push_back(id); });
+    REQUIRE(leaves.size() > 20);
+
+    for (const auto& leaf : leaves) {
+        const auto covers_leaf = [&](const tile::Id& id) { return tile::covers(id, leaf); };
+        auto path = quad_tree::pathTo(root, covers_leaf);
+        REQUIRE(!path.empty());
+        REQUIRE(path.back()->data() == leaf);
+        for (const auto direction : { tile::Direction::East, tile::Direction::West, tile::Direction::North, tile::Direction::South }) {
+            const auto neighbour = tile::neighbour(leaf, direction);
+            if (!neighbour)
+                continue;
+            const auto covers_neighbour = [&](const tile::Id& id) { return tile::covers(id, *neighbour); };
+            auto moved_path = path;
+            const auto* node = quad_tree::moveTo(&moved_path, covers_neighbour);
+            REQUIRE(node);
+            // either the leaf containing the neighbour, or the neighbour itself if the tree is finer there
+            CHECK((node->data() == *neighbour || (!node->hasChildren() && tile::covers(node->data(), *neighbour))));
+            const auto from_root = quad_tree::pathTo(root, covers_neighbour);
+            CHECK(moved_path == from_root);
+        }
+    }
+
+    auto path = quad_tree::pathTo(root, [](const tile::Id& id) { return tile::covers(id, { 6, { 0, 0 } }); });
+    CHECK(!quad_tree::moveTo(&path, [](const tile::Id& id) { return id.zoom_level == 100; }));
+    CHECK(path.back()->data() == tile::Id { 6, { 0, 0 } });
+}
@@ -0,0 +1,164 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <radix/ray_casting.h>
+
+using Catch::Approx;
+using namespace radix;
+
+namespace {
+constexpr unsigned max_zoom = 5;
+
+tile::SrsBounds unit_square_bounds(const tile::Id& id)
+{
+    const auto size = 1.0 / double(1u << id.zoom_level);
+    const auto min = glm::dvec2(id.coords) * size;
+    return { min, min + glm::dvec2(size) };
+}
+
+// a smooth hill, the height ranges of the tiles are computed bottom up, so parents contain their children
+TileHeights hill_heights()
+{
+    TileHeights heights;
+    const auto height = [](const glm::dvec2& p) { return float(0.5 * std::exp(-10 * glm::dot(p - 0.5, p - 0.5))); };
+    std::vector<std::pair<float, float>> level;
+    for (unsigned zoom = max_zoom + 1; zoom-- > 0;) {
+        const auto n = 1u << zoom;
+        std::vector<std::pair<float, float>> current(n * n);
+        for (unsigned y = 0; y < n; ++y) {
+            for (unsigned x = 0; x < n; ++x) {
+                auto& range = current[y * n + x];
+                if (zoom == max_zoom) {
+                    const auto bounds = unit_square_bounds({ zoom, { x, y } });
+                    const auto corners = std::array { height(bounds.min), height(bounds.max), height({ bounds.min.x, bounds.max.y }), height({ bounds.max.x, bounds.min.y }) };
+                    range = { *std::min_element(corners.begin(), corners.end()), *std::max_element(corners.begin(), corners.end()) };
+                } else {
+                    range = { std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest() };
+                    for (unsigned i = 0; i < 4; ++i) {
+                        const auto& child = level[(2 * y + i / 2) * (2 * n) + 2 * x + i % 2];
+                        range = { std::min(range.first, child.first), std::max(range.second, child.second) };
+                    }
+                }
+                heights.emplace({ zoom, { x, y } }, range);
+            }
+        }
+        level = std::move(current);
+    }
+    return heights;
+}
+
+std::vector<TileRayHit> brute_force(const TileHeights& heights, const geometry::Line<3, double>& ray)
+{
+    std::vector<TileRayHit> hits;
+    const auto n = 1u << max_zoom;
+    for (unsigned y = 0; y < n; ++y) {
+        for (unsigned x = 0; x < n; ++x) {
+            const auto id = tile::Id { max_zoom, { x, y } };
+            const auto bounds = unit_square_bounds(id);
+            const auto [min_height, max_height] = heights.query(id);
+            const auto box = geometry::Aabb3d { glm::dvec3(bounds.min, min_height), glm::dvec3(bounds.max, max_height) };
+            if (const auto interval = geometry::ray_intersection(ray, box))
+                hits.push_back({ id, interval->first, interval->second });
+        }
+    }
+    return hits;
+}
+} // namespace
+
+TEST_CASE("radix/geometry: ray box intersection")
+{
+    const auto box = geometry::Aabb3d { { 0.0, 0.0, 0.0 }, { 1.0, 2.0, 3.0 } };
+    {
+        const auto interval = geometry::ray_intersection(geometry::Line<3, double> { { -1.0, 0.5, 0.5 }, { 1.0, 0.0, 0.0 } }, box);
+        REQUIRE(interval);
+        CHECK(interval->first == Approx(1.0));
+        CHECK(interval->second == Approx(2.0));
+    }
+    {
+        // starting inside
+        const auto interval = geometry::ray_intersection(geometry::Line<3, double> { { 0.5, 0.5, 0.5 }, { 0.0, 0.0, -2.0 } }, box);
+        REQUIRE(interval);
+        CHECK(interval->first == 0.0);
+        CHECK(interval->second == Approx(0.25));
+    }
+    CHECK(!geometry::ray_intersection(geometry::Line<3, double> { { -1.0, 0.5, 0.5 }, { -1.0, 0.0, 0.0 } }, box)); // pointing away
+    CHECK(!geometry::ray_intersection(geometry::Line<3, double> { { -1.0, 2.5, 0.5 }, { 1.0, 0.0, 0.0 } }, box)); // parallel, outside
+    CHECK(!geometry::ray_intersection(geometry::Line<3, double> { { -1.0, 0.5, 0.5 }, { 1.0, 10.0, 0.0 } }, box)); // passing by
+}
+
+TEST_CASE("radix/ray_casting")
+{
+    const auto heights = hill_heights();
+
+    SECTION("vertical ray hits the tile below")
+    {
+        const auto ray = geometry::Line<3, double> { { 0.51, 0.52, 10.0 }, { 0.0, 0.0, -1.0 } };
+        auto hits = ray_cast(&heights, ray, unit_square_bounds, max_zoom);
+        auto iter = hits.begin();
+        REQUIRE(iter != hits.end());
+        CHECK(iter->id == tile::Id { max_zoom, { 16, 16 } });
+        CHECK(iter->t_entry == Approx(10.0 - heights.query(iter->id).second));
+        ++iter;
+        CHECK(iter == hits.end());
+    }
+
+    SECTION("same candidates as brute force, front to back")
+    {
+        const auto rays = std::array {
+            geometry::Line<3, double> { { -0.2, 0.1, 0.6 }, { 1.0, 0.7, -0.4 } },
+            geometry::Line<3, double> { { 0.1, 0.9, 0.45 }, { 1.0, -1.0, 0.0 } }, // horizontal, through the hill top
+            geometry::Line<3, double> { { 0.5, 0.5, 0.3 }, { 0.3, 0.1, 0.05 } }, // starting inside the terrain's bounding box
+        };
+        for (const auto& ray : rays) {
+            std::vector<TileRayHit> hits;
+            for (const auto& hit : ray_cast(&heights, ray, unit_square_bounds, max_zoom))
+                hits.push_back(hit);
+            auto expected = brute_force(heights, ray);
+            REQUIRE(!expected.empty());
+            REQUIRE(hits.size() == expected.size());
+            CHECK(std::is_sorted(hits.begin(), hits.end(), [](const auto& a, const auto& b) { return a.t_entry < b.t_entry; }));
+
+            const auto by_id = [](const TileRayHit& a, const TileRayHit& b) { return a.id < b.id; };
+            auto sorted_hits = hits;
+            std::sort(sorted_hits.begin(), sorted_hits.end(), by_id);
+            std::sort(expected.begin(), expected.end(), by_id);
+            for (size_t i = 0; i < hits.size(); ++i) {
+                CHECK(sorted_hits[i].id == expected[i].id);
+                CHECK(sorted_hits[i].t_entry == expected[i].t_entry);
+                CHECK(sorted_hits[i].t_exit == expected[i].t_exit);
+            }
+
+            const auto interval = ray_cast_interval(heights, ray, unit_square_bounds, max_zoom);
+            REQUIRE(interval);
+            CHECK(interval->first == hits.front().t_entry);
+        }
+    }
+
+    SECTION("miss")
+    {
+        const auto ray = geometry::Line<3, double> { { -0.5, 0.5, 1.0 }, { -1.0, 0.0, 0.0 } };
+        CHECK(ray_cast(&heights, ray, unit_square_bounds, max_zoom).begin() == std::default_sentinel);
+        CHECK(!ray_cast_interval(heights, ray, unit_square_bounds, max_zoom));
+    }
+}
@@ -0,0 +1,179 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <radix/simd.h>
+
+using namespace radix;
+
+namespace {
+template <typename Batch, typename Function>
+std::vector<double> evaluate(const std::vector<double>& x, const Function& f)
+{
+    std::vector<double> out(x.size());
+    for (size_t i = 0; i + Batch::width <= x.size(); i += Batch::width)
+        f(Batch::load(x.data() + i)).store(out.data() + i);
+    return out;
+}
+
+// largest error in units of the last place of the reference
+template <typename Batch, typename Function, typename Reference>
+double max_ulp_error(const std::vector<double>& x, const Function& f, const Reference& reference)
+{
+    const auto result = evaluate<Batch>(x, f);
+    double max_error = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        const auto expected = reference(x[i]);
+        const auto ulp = std::max(std::abs(expected), std::numeric_limits<double>::min()) * std::numeric_limits<double>::epsilon();
+        max_error = std::max(max_error, std::abs(result[i] - expected) / ulp);
+    }
+    return max_error;
+}
+
+std::vector<double> samples(double from, double to)
+{
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> value(from, to);
+    std::vector<double> x;
+    for (int i = 0; i < 40'000; ++i)
+        x.push_back(value(rng));
+    return x;
+}
+
+template <typename Batch>
+void check_elementary_functions()
+{
+    const auto exp = [](Batch x) { return simd::exp(x); };
+    const auto log = [](Batch x) { return simd::log(x); };
+    const auto atan = [](Batch x) { return simd::atan(x); };
+    const auto sin = [](Batch x) { return simd::sin(x); };
+    const auto cos = [](Batch x) { return simd::cos(x); };
+    const auto std_exp = [](double x) { return std::exp(x); };
+    const auto std_log = [](double x) { return std::log(x); };
+    const auto std_atan = [](double x) { return std::atan(x); };
+    const auto std_sin = [](double x) { return std::sin(x); };
+    const auto std_cos = [](double x) { return std::cos(x); };
+
+    CHECK(max_ulp_error<Batch>(samples(-1, 1), exp, std_exp) < 2);
+    CHECK(max_ulp_error<Batch>(samples(-700, 700), exp, std_exp) < 2);
+    CHECK(max_ulp_error<Batch>(samples(0.5, 2), log, std_log) < 4);
+    CHECK(max_ulp_error<Batch>(samples(1e-300, 1e300), log, std_log) < 2);
+    CHECK(max_ulp_error<Batch>(samples(1e-6, 1e-3), log, std_log) < 2);
+    CHECK(max_ulp_error<Batch>(samples(-1, 1), atan, std_atan) < 2);
+    CHECK(max_ulp_error<Batch>(samples(-100, 100), atan, std_atan) < 2);
+    CHECK(max_ulp_error<Batch>(samples(-1e10, 1e10), atan, std_atan) < 2);
+    CHECK(max_ulp_error<Batch>(samples(-1.6, 1.6), sin, std_sin) < 2);
+    CHECK(max_ulp_error<Batch>(samples(-1.6, 1.6), cos, std_cos) < 2);
+    // close to the zeros the reference is tiny, the absolute error is what matters there
+    const auto x = samples(-1000, 1000);
+    const auto sin_result = evaluate<Batch>(x, sin);
+    const auto cos_result = evaluate<Batch>(x, cos);
+    double max_error = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        max_error = std::max(max_error, std::abs(sin_result[i] - std::sin(x[i])));
+        max_error = std::max(max_error, std::abs(cos_result[i] - std::cos(x[i])));
+    }
+    CHECK(max_error < 1e-15);
+    // near the poles (web mercator), relative accuracy matters
+    CHECK(max_ulp_error<Batch>(samples(1.48, 1.5707963267948966), cos, std_cos) < 2);
+
+    CHECK(evaluate<Batch>(std::vector<double>(Batch::width, 0.0), exp).front() == 1.0);
+    CHECK(evaluate<Batch>(std::vector<double>(Batch::width, 1.0), log).front() == 0.0);
+    CHECK(evaluate<Batch>(std::vector<double>(Batch::width, 0.0), atan).front() == 0.0);
+    CHECK(evaluate<Batch>(std::vector<double>(Batch::width, 0.0), sin).front() == 0.0);
+    CHECK(evaluate<Batch>(std::vector<double>(Batch::width, 0.0), cos).front() == 1.0);
+
+    const auto square_root = [](Batch x) { return sqrt(x); };
+    CHECK(max_ulp_error<Batch>(samples(0, 1e10), square_root, [](double x) { return std::sqrt(x); }) == 0);
+
+    // all quadrants, the axes and the origin
+    auto ys = samples(-100, 100);
+    auto xs = samples(-1e5, 1e5);
+    std::shuffle(xs.begin(), xs.end(), std::mt19937(1));
+    for (const auto special : { 0.0, 1.0, -1.0 }) {
+        for (size_t l = 0; l < Batch::width; ++l) {
+            xs.push_back(special);
+            ys.push_back(l % 2 ? 0.0 : 3.0);
+            xs.push_back(l % 2 ? 0.0 : -3.0);
+            ys.push_back(special);
+        }
+    }
+    std::vector<double> atan2_result(xs.size());
+    for (size_t i = 0; i + Batch::width <= xs.size(); i += Batch::width)
+        simd::atan2(Batch::load(ys.data() + i), Batch::load(xs.data() + i)).store(atan2_result.data() + i);
+    double max_atan2_error = 0;
+    for (size_t i = 0; i < xs.size(); ++i) {
+        const auto expected = std::atan2(ys[i], xs[i]);
+        const auto ulp = std::max(std::abs(expected), std::numeric_limits<double>::min()) * std::numeric_limits<double>::epsilon();
+        max_atan2_error = std::max(max_atan2_error, std::abs(atan2_result[i] - expected) / ulp);
+    }
+    CHECK(max_atan2_error < 3);
+}
+} // namespace
+
+TEST_CASE("radix/simd elementary functions")
+{
+    SECTION("scalar") { check_elementary_functions<simd::Scalar<double>>(); }
+    SECTION("native") { check_elementary_functions<simd::Batch<double>>(); }
+
+    SECTION("ldexp and frexp")
+    {
+        using Batch = simd::Batch<double>;
+        std::vector<double> x = { 1.0, -3.0, 0.75, 1e-300, 1e300, -2.5e-10, 12345.678, 0.1 };
+        std::vector<double> n = { 0.0, 1.0, -1.0, 1000.0, -1000.0, 20.0, -1022.0, 1023.0 };
+        for (size_t i = 0; i + Batch::width <= x.size(); i += Batch::width) {
+            std::array<double, Batch::width> mantissa;
+            std::array<double, Batch::width> exponent;
+            auto e = Batch::broadcast(0);
+            frexp(Batch::load(x.data() + i), &e).store(mantissa.data());
+            e.store(exponent.data());
+            for (size_t l = 0; l < Batch::width; ++l) {
+                int expected_exponent = 0;
+                CHECK(mantissa[l] == std::frexp(x[i + l], &expected_exponent));
+                CHECK(exponent[l] == expected_exponent);
+            }
+            ldexp(Batch::broadcast(1.5), Batch::load(n.data() + i)).store(mantissa.data());
+            for (size_t l = 0; l < Batch::width; ++l)
+                CHECK(mantissa[l] == std::ldexp(1.5, int(n[i + l])));
+        }
+    }
+
+    SECTION("store_truncated")
+    {
+        const std::vector<double> x = { 0.0, 0.99, 1.5, -1.5, 2147483647.0, -2147483648.0, 1e9 + 0.5, -7.9 };
+        std::vector<int32_t> doubles(x.size());
+        for (size_t i = 0; i + simd::Batch<double>::width <= x.size(); i += simd::Batch<double>::width)
+            simd::Batch<double>::load(x.data() + i).store_truncated(doubles.data() + i);
+        const std::vector<float> y = { 0.0f, 0.99f, 1.5f, -1.5f, 16777216.0f, -2147483648.0f, 1e6f + 0.5f, -7.9f };
+        std::vector<int32_t> floats(y.size());
+        for (size_t i = 0; i + simd::Batch<float>::width <= y.size(); i += simd::Batch<float>::width)
+            simd::Batch<float>::load(y.data() + i).store_truncated(floats.data() + i);
+        for (size_t i = 0; i < x.size(); ++i)
+            CHECK(doubles[i] == int32_t(x[i]));
+        for (size_t i = 0; i < y.size(); ++i)
+            CHECK(floats[i] == int32_t(y[i]));
+    }
+}
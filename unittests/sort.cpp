@@ -0,0 +1,136 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <radix/sort.h>
+
+using namespace radix;
+
+namespace {
+std::vector<tile::Id> random_ids(size_t n, unsigned min_zoom, unsigned max_zoom)
+{
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<unsigned> zoom(min_zoom, max_zoom);
+    std::uniform_int_distribution<unsigned> coord;
+    std::vector<tile::Id> ids;
+    ids.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto z = zoom(rng);
+        const auto mask = (1u << z) - 1;
+        ids.push_back({ z, { coord(rng) & mask, coord(rng) & mask } });
+    }
+    return ids;
+}
+} // namespace
+
+TEST_CASE("radix/sort")
+{
+    SECTION("keys")
+    {
+        std::mt19937_64 rng(0);
+        for (const auto n_threads : { 1u, 3u, 8u }) {
+            for (const size_t n : { size_t(0), size_t(1), size_t(1000), size_t(300'000) }) {
+                std::vector<uint64_t> keys(n);
+                for (auto& key : keys)
+                    key = rng() >> (rng() % 64); // varying number of significant bits
+                auto expected = keys;
+                std::sort(expected.begin(), expected.end());
+                radix_sort(std::span(keys), n_threads);
+                CHECK(keys == expected);
+            }
+        }
+    }
+
+    SECTION("stable with values")
+    {
+        std::mt19937_64 rng(1);
+        for (const auto n_threads : { 1u, 4u }) {
+            std::vector<uint64_t> keys(200'000);
+            std::vector<std::pair<uint64_t, uint32_t>> expected;
+            std::vector<uint32_t> values(keys.size());
+            for (size_t i = 0; i < keys.size(); ++i) {
+                keys[i] = (rng() % 1000) << 20; // few distinct keys, only a few digits vary
+                values[i] = uint32_t(i);
+                expected.emplace_back(keys[i], values[i]);
+            }
+            std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            radix_sort(std::span(keys), std::span(values), n_threads);
+            for (size_t i = 0; i < keys.size(); ++i) {
+                REQUIRE(keys[i] == expected[i].first);
+                REQUIRE(values[i] == expected[i].second);
+            }
+        }
+    }
+
+    SECTION("tile keys")
+    {
+        for (const auto& id : random_ids(1000, 0, 29)) {
+            CHECK(tile::from_key(tile::to_key(id, tile::KeyOrder::ZoomMajor), tile::KeyOrder::ZoomMajor) == id);
+            CHECK(tile::from_key(tile::to_key(id, tile::KeyOrder::Morton), tile::KeyOrder::Morton) == id);
+            CHECK(tile::from_key(tile::to_key(id, tile::KeyOrder::QuadTree), tile::KeyOrder::QuadTree) == id);
+            if (id.zoom_level > 0)
+                CHECK(tile::to_key(id.parent(), tile::KeyOrder::QuadTree) < tile::to_key(id, tile::KeyOrder::QuadTree));
+            const auto slippy = id.to(tile::Scheme::SlippyMap);
+            CHECK(tile::from_key(tile::to_key(slippy, tile::KeyOrder::Morton), tile::KeyOrder::Morton, tile::Scheme::SlippyMap) == slippy);
+        }
+    }
+
+    SECTION("tile ids")
+    {
+        auto ids = random_ids(100'000, 0, 18);
+        auto expected = ids;
+        std::sort(expected.begin(), expected.end());
+        tile::sort(ids, tile::KeyOrder::ZoomMajor, 4);
+        CHECK(ids == expected);
+
+        tile::sort(ids, tile::KeyOrder::Morton);
+        CHECK(std::is_sorted(ids.begin(), ids.end(), [](const tile::Id& a, const tile::Id& b) {
+            return std::make_pair(a.zoom_level, morton::encode(a.coords)) < std::make_pair(b.zoom_level, morton::encode(b.coords));
+        }));
+        CHECK(std::is_permutation(ids.begin(), ids.end(), expected.begin(), [](const tile::Id& a, const tile::Id& b) { return a == b; }));
+    }
+}
+
+TEST_CASE("radix/sort: performance")
+{
+    const auto ids = random_ids(2'000'000, 10, 20);
+    BENCHMARK("std::sort (2e6 tile ids)")
+    {
+        auto copy = ids;
+        std::sort(copy.begin(), copy.end());
+        return copy.front();
+    };
+    BENCHMARK("tile::sort (2e6 tile ids)")
+    {
+        auto copy = ids;
+        tile::sort(copy);
+        return copy.front();
+    };
+    BENCHMARK("tile::sort, 4 threads (2e6 tile ids)")
+    {
+        auto copy = ids;
+        tile::sort(copy, tile::KeyOrder::ZoomMajor, 4);
+        return copy.front();
+    };
+}
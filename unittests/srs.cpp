@@ -0,0 +1,231 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <random>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <radix/srs.h>
+
+using Catch::Approx;
+using namespace radix;
+
+namespace {
+std::vector<glm::dvec3> random_lat_long_alt(size_t n)
+{
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> latitude(-85, 85);
+    std::uniform_real_distribution<double> longitude(-180, 180);
+    std::uniform_real_distribution<double> altitude(-500, 9000);
+    std::vector<glm::dvec3> points;
+    points.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        points.emplace_back(latitude(rng), longitude(rng), altitude(rng));
+    return points;
+}
+} // namespace
+
+TEST_CASE("radix/srs")
+{
+    SECTION("web mercator known values")
+    {
+        CHECK(srs::lat_long_to_world({ 0.0, 0.0 }).x == Approx(0.0));
+        CHECK(srs::lat_long_to_world({ 0.0, 0.0 }).y == Approx(0.0).margin(0.000001));
+        CHECK(srs::lat_long_to_world({ 0.0, 180.0 }).x == Approx(20037508.342789244));
+        CHECK(srs::lat_long_to_world({ 85.0511287798066, 0.0 }).y == Approx(20037508.342789244));
+        // Stephansdom, Vienna
+        const auto world = srs::lat_long_to_world({ 48.208530, 16.373146 });
+        CHECK(world.x == Approx(1822650.275));
+        CHECK(world.y == Approx(6141617.178));
+    }
+
+    SECTION("ecef known values")
+    {
+        const auto equator = srs::lat_long_alt_to_ecef({ 0.0, 0.0, 0.0 });
+        CHECK(equator.x == Approx(6378137.0));
+        CHECK(equator.y == Approx(0.0).margin(0.000001));
+        CHECK(equator.z == Approx(0.0).margin(0.000001));
+        const auto pole = srs::lat_long_alt_to_ecef({ 90.0, 0.0, 100.0 });
+        CHECK(pole.x == Approx(0.0).margin(0.000001));
+        CHECK(pole.z == Approx(6356752.314245 + 100.0));
+        const auto east = srs::lat_long_alt_to_ecef({ 0.0, 90.0, 0.0 });
+        CHECK(east.y == Approx(6378137.0));
+    }
+
+    SECTION("batch kernels match the scalar versions and round trip")
+    {
+        const auto points = random_lat_long_alt(1001); // not a multiple of the simd width
+        std::vector<glm::dvec2> lat_long;
+        for (const auto& p : points)
+            lat_long.emplace_back(p);
+
+        std::vector<glm::dvec2> world(points.size());
+        srs::lat_long_to_world(lat_long, world);
+        std::vector<glm::dvec2> lat_long_again(points.size());
+        srs::world_to_lat_long(world, lat_long_again);
+
+        std::vector<glm::dvec3> ecef(points.size());
+        srs::lat_long_alt_to_ecef(points, ecef);
+        std::vector<glm::dvec3> points_again(points.size());
+        srs::ecef_to_lat_long_alt(ecef, points_again);
+
+        std::vector<glm::dvec3> world_alt;
+        for (size_t i = 0; i < points.size(); ++i)
+            world_alt.emplace_back(world[i], points[i].z);
+        std::vector<glm::dvec3> ecef_from_world(points.size());
+        srs::world_to_ecef(world_alt, ecef_from_world);
+
+        for (size_t i = 0; i < points.size(); ++i) {
+            CHECK(glm::distance(world[i], srs::lat_long_to_world(lat_long[i])) < 1e-7);
+            CHECK(glm::distance(lat_long_again[i], srs::world_to_lat_long(world[i])) < 1e-12);
+            CHECK(glm::distance(ecef[i], srs::lat_long_alt_to_ecef(points[i])) < 1e-6);
+            const auto scalar_points_again = srs::ecef_to_lat_long_alt(ecef[i]);
+            CHECK(glm::distance(glm::dvec2(points_again[i]), glm::dvec2(scalar_points_again)) < 1e-12);
+            CHECK(points_again[i].z == Approx(scalar_points_again.z).margin(1e-6));
+            CHECK(glm::distance(ecef_from_world[i], srs::world_to_ecef(world_alt[i])) < 1e-6);
+            CHECK(glm::distance(lat_long_again[i], lat_long[i]) < 1e-9);
+            CHECK(glm::distance(glm::dvec2(points_again[i]), lat_long[i]) < 1e-9);
+            CHECK(points_again[i].z == Approx(points[i].z).margin(0.001));
+            CHECK(glm::distance(ecef_from_world[i], ecef[i]) < 0.001);
+        }
+
+        // in place
+        srs::lat_long_to_world(lat_long, lat_long);
+        CHECK(lat_long == world);
+    }
+
+    SECTION("tile bounds")
+    {
+        const auto e = srs::web_mercator_extent;
+        CHECK(srs::tile_bounds({ 0, { 0, 0 } }, srs::epsg_web_mercator) == tile::SrsBounds { { -e, -e }, { e, e } });
+        CHECK(srs::tile_bounds({ 1, { 1, 1 } }, srs::epsg_web_mercator) == tile::SrsBounds { { 0, 0 }, { e, e } });
+        CHECK(srs::tile_bounds({ 1, { 1, 0 }, tile::Scheme::SlippyMap }, srs::epsg_web_mercator) == tile::SrsBounds { { 0, 0 }, { e, e } });
+        const auto north_west = srs::tile_bounds({ 2, { 0, 0 }, tile::Scheme::SlippyMap }, srs::epsg_web_mercator);
+        CHECK(north_west.min.x == Approx(-e));
+        CHECK(north_west.min.y == Approx(e / 2));
+        CHECK(north_west.max.x == Approx(-e / 2));
+        CHECK(north_west.max.y == Approx(e));
+        CHECK(srs::tile_bounds({ 0, { 1, 0 } }, srs::epsg_wgs84) == tile::SrsBounds { { 0, -90 }, { 180, 90 } });
+        CHECK(srs::tile_bounds({ 1, { 0, 1 } }, srs::epsg_wgs84) == tile::SrsBounds { { -180, 0 }, { -90, 90 } });
+
+        // every Tms tile has the same bounds as its SlippyMap twin
+        for (unsigned y = 0; y < 8; ++y) {
+            for (unsigned x = 0; x < 8; ++x) {
+                const auto id = tile::Id { 3, { x, y } };
+                CHECK(srs::tile_bounds(id, srs::epsg_web_mercator) == srs::tile_bounds(id.to(tile::Scheme::SlippyMap), srs::epsg_web_mercator));
+            }
+        }
+
+        const auto with_border = srs::tile_bounds({ 0, { 0, 0 } }, srs::epsg_web_mercator, 64, tile::Border::Yes);
+        CHECK(with_border.min == glm::dvec2(-e));
+        CHECK(with_border.max == glm::dvec2(e + 2 * e / 64));
+        CHECK(srs::tile_bounds({ 0, { 0, 0 } }, srs::epsg_web_mercator, 64, tile::Border::No) == srs::tile_bounds({ 0, { 0, 0 } }, srs::epsg_web_mercator));
+    }
+
+    SECTION("descriptors")
+    {
+        std::vector<tile::Id> ids;
+        for (unsigned y = 0; y < 16; ++y) {
+            for (unsigned x = 0; x < 16; ++x)
+                ids.push_back({ 4, { x, y } });
+        }
+        std::vector<tile::Descriptor> descriptors(ids.size());
+        srs::fill_descriptors(ids, srs::epsg_web_mercator, 64, tile::Border::Yes, descriptors);
+        std::vector<tile::SrsBounds> bounds(ids.size());
+        srs::tile_bounds(ids, srs::epsg_web_mercator, 64, tile::Border::Yes, bounds);
+        for (size_t i = 0; i < ids.size(); ++i) {
+            CHECK(descriptors[i].id == ids[i]);
+            CHECK(descriptors[i].srs_epsg == 3857);
+            CHECK(descriptors[i].gridSize == 64);
+            CHECK(descriptors[i].tileSize == 65);
+            CHECK(descriptors[i].srsBounds == bounds[i]);
+            CHECK(descriptors[i].srsBounds.min == srs::tile_bounds(ids[i], srs::epsg_web_mercator).min);
+        }
+    }
+}
+
+TEST_CASE("radix/srs: performance")
+{
+    const auto points = random_lat_long_alt(100'000);
+    std::vector<glm::dvec3> ecef(points.size());
+    srs::lat_long_alt_to_ecef(points, ecef);
+    std::vector<glm::dvec3> points_again(points.size());
+    std::vector<glm::dvec2> lat_long;
+    for (const auto& p : points)
+        lat_long.emplace_back(p);
+    std::vector<glm::dvec2> world(points.size());
+    std::vector<tile::Id> ids;
+    for (unsigned y = 0; y < 256; ++y) {
+        for (unsigned x = 0; x < 256; ++x)
+            ids.push_back({ 8, { x, y } });
+    }
+    std::vector<tile::Descriptor> descriptors(ids.size());
+
+    BENCHMARK("scalar lat_long_to_world loop (100k points)")
+    {
+        for (size_t i = 0; i < lat_long.size(); ++i)
+            world[i] = srs::lat_long_to_world(lat_long[i]);
+        return world.back();
+    };
+    BENCHMARK("lat_long_to_world (100k points)")
+    {
+        srs::lat_long_to_world(lat_long, world);
+        return world.back();
+    };
+    BENCHMARK("scalar world_to_lat_long loop (100k points)")
+    {
+        for (size_t i = 0; i < world.size(); ++i)
+            lat_long[i] = srs::world_to_lat_long(world[i]);
+        return lat_long.back();
+    };
+    BENCHMARK("world_to_lat_long (100k points)")
+    {
+        srs::world_to_lat_long(world, lat_long);
+        return lat_long.back();
+    };
+    BENCHMARK("scalar lat_long_alt_to_ecef loop (100k points)")
+    {
+        for (size_t i = 0; i < points.size(); ++i)
+            ecef[i] = srs::lat_long_alt_to_ecef(points[i]);
+        return ecef.back();
+    };
+    BENCHMARK("lat_long_alt_to_ecef (100k points)")
+    {
+        srs::lat_long_alt_to_ecef(points, ecef);
+        return ecef.back();
+    };
+    BENCHMARK("scalar ecef_to_lat_long_alt loop (100k points)")
+    {
+        for (size_t i = 0; i < ecef.size(); ++i)
+            points_again[i] = srs::ecef_to_lat_long_alt(ecef[i]);
+        return points_again.back();
+    };
+    BENCHMARK("ecef_to_lat_long_alt (100k points)")
+    {
+        srs::ecef_to_lat_long_alt(ecef, points_again);
+        return points_again.back();
+    };
+    BENCHMARK("fill_descriptors (65k tiles)")
+    {
+        srs::fill_descriptors(ids, srs::epsg_web_mercator, 64, tile::Border::Yes, descriptors);
+        return descriptors.back().srsBounds;
+    };
+}
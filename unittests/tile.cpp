@@ -16,6 +16,11 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *****************************************************************************/
 
+#include <array>
+#include <string>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include <radix/tile.h>
@@ -177,3 +182,170 @@ TEST_CASE("radix/tile::Id/children")
         }
     }
 }
+
+TEST_CASE("radix/tile: neighbours")
+{
+    using tile::Direction;
+    using tile::Scheme;
+    SECTION("same level")
+    {
+        const auto id = tile::Id { 3, { 2, 5 } };
+        CHECK(tile::neighbour(id, Direction::East) == tile::Id { 3, { 3, 5 } });
+        CHECK(tile::neighbour(id, Direction::West) == tile::Id { 3, { 1, 5 } });
+        CHECK(tile::neighbour(id, Direction::North) == tile::Id { 3, { 2, 6 } });
+        CHECK(tile::neighbour(id, Direction::South) == tile::Id { 3, { 2, 4 } });
+
+        const auto slippy = id.to(Scheme::SlippyMap);
+        for (const auto direction : { Direction::East, Direction::West, Direction::North, Direction::South })
+            CHECK(tile::neighbour(slippy, direction) == tile::neighbour(id, direction)->to(Scheme::SlippyMap));
+
+        // wrapping in x, nothing beyond the poles
+        CHECK(tile::neighbour({ 3, { 7, 7 } }, Direction::East) == tile::Id { 3, { 0, 7 } });
+        CHECK(tile::neighbour({ 3, { 0, 0 } }, Direction::West) == tile::Id { 3, { 7, 0 } });
+        CHECK(!tile::neighbour({ 3, { 0, 7 } }, Direction::North));
+        CHECK(!tile::neighbour({ 3, { 0, 0 } }, Direction::South));
+        CHECK(!tile::neighbour({ 3, { 0, 0 }, Scheme::SlippyMap }, Direction::North));
+        CHECK(tile::neighbour({ 0, { 0, 0 } }, Direction::East) == tile::Id { 0, { 0, 0 } });
+        CHECK(!tile::neighbour({ 0, { 0, 0 } }, Direction::North));
+    }
+
+    SECTION("morton codes give the same result")
+    {
+        for (const auto scheme : { Scheme::Tms, Scheme::SlippyMap }) {
+            for (unsigned zoom = 0; zoom < 5; ++zoom) {
+                for (unsigned y = 0; y < (1u << zoom); ++y) {
+                    for (unsigned x = 0; x < (1u << zoom); ++x) {
+                        const auto id = tile::Id { zoom, { x, y }, scheme };
+                        for (const auto direction : { Direction::East, Direction::West, Direction::North, Direction::South }) {
+                            const auto expected = tile::neighbour(id, direction);
+                            const auto code = tile::neighbour(morton::encode(id.coords), zoom, scheme, direction);
+                            REQUIRE(bool(code) == bool(expected));
+                            if (code)
+                                CHECK(morton::decode(*code) == expected->coords);
+                        }
+                    }
+                }
+            }
+        }
+        CHECK(morton::increment_x(morton::encode({ 0xFFFF'FFFF, 3 })) == morton::encode({ 0, 3 }));
+        CHECK(morton::decrement_y(morton::encode({ 5, 0 })) == morton::encode({ 5, 0xFFFF'FFFF }));
+    }
+
+    SECTION("covers")
+    {
+        CHECK(tile::covers({ 0, { 0, 0 } }, { 5, { 17, 3 } }));
+        CHECK(tile::covers({ 2, { 2, 0 } }, { 5, { 17, 3 } }));
+        CHECK(tile::covers({ 5, { 17, 3 } }, { 5, { 17, 3 } }));
+        CHECK(!tile::covers({ 2, { 2, 1 } }, { 5, { 17, 3 } }));
+        CHECK(!tile::covers({ 5, { 17, 3 } }, { 2, { 2, 0 } }));
+    }
+}
+
+namespace {
+constexpr bool constexpr_round_trip()
+{
+    char buffer[tile::max_zxy_chars] = {};
+    const auto written = tile::to_chars(buffer, buffer + sizeof(buffer), tile::Id { 12, { 2200, 1400 } });
+    tile::Id parsed;
+    const auto read = tile::from_chars(buffer, written.ptr, parsed);
+    return read.ec == std::errc() && read.ptr == written.ptr && parsed == tile::Id { 12, { 2200, 1400 } };
+}
+static_assert(constexpr_round_trip());
+} // namespace
+
+TEST_CASE("radix/tile: formatting and parsing")
+{
+    const auto format = [](const tile::Id& id) {
+        std::array<char, tile::max_zxy_chars> buffer;
+        const auto result = tile::to_chars(buffer.data(), buffer.data() + buffer.size(), id);
+        REQUIRE(result.ec == std::errc());
+        return std::string(buffer.data(), result.ptr);
+    };
+    const auto quadkey = [](const tile::Id& id) {
+        std::array<char, tile::max_quadkey_chars> buffer;
+        const auto result = tile::to_quadkey(buffer.data(), buffer.data() + buffer.size(), id);
+        REQUIRE(result.ec == std::errc());
+        return std::string(buffer.data(), result.ptr);
+    };
+
+    SECTION("z/x/y")
+    {
+        CHECK(format({ 0, { 0, 0 } }) == "0/0/0");
+        CHECK(format({ 18, { 142'896, 91'043 }, tile::Scheme::SlippyMap }) == "18/142896/91043");
+        CHECK(format({ 31, { 2'147'483'647, 2'147'483'647 } }).size() == tile::max_zxy_chars);
+        CHECK(tile::to_string({ 3, { 1, 2 }, tile::Scheme::SlippyMap }) == "SlippyMap:3/1/2");
+        CHECK(tile::to_string({ 3, { 1, 2 } }) == "Tms:3/1/2");
+        // invalid ids are printed as well, e.g., in catch2 failure messages
+        CHECK(tile::to_string({ unsigned(-1), { unsigned(-1), 4000000000u }, tile::Scheme::SlippyMap }) == "SlippyMap:4294967295/4294967295/4000000000");
+
+        std::array<char, 5> small;
+        CHECK(tile::to_chars(small.data(), small.data() + small.size(), { 10, { 100, 100 } }).ec == std::errc::value_too_large);
+        CHECK(tile::to_chars(small.data(), small.data() + small.size(), { 1, { 1, 1 } }).ec == std::errc());
+
+        const std::string path = "14/8927/5689.png";
+        tile::Id id;
+        auto result = tile::from_chars(path.data(), path.data() + path.size(), id, tile::Scheme::SlippyMap);
+        CHECK(result.ec == std::errc());
+        CHECK(std::string(result.ptr) == ".png");
+        CHECK(id == tile::Id { 14, { 8927, 5689 }, tile::Scheme::SlippyMap });
+
+        for (const std::string invalid : { "", "1", "1/2", "1//2", "a/1/1", "1/1/", "1/-1/0", "1/99999999999/0" }) {
+            result = tile::from_chars(invalid.data(), invalid.data() + invalid.size(), id);
+            CHECK(result.ec == std::errc::invalid_argument);
+            CHECK(result.ptr == invalid.data());
+        }
+        for (const std::string out_of_range : { "2/4/0", "2/0/4", "32/0/0" })
+            CHECK(tile::from_chars(out_of_range.data(), out_of_range.data() + out_of_range.size(), id).ec == std::errc::result_out_of_range);
+    }
+
+    SECTION("quadkey")
+    {
+        // examples from https://learn.microsoft.com/en-us/bingmaps/articles/bing-maps-tile-system
+        CHECK(quadkey({ 3, { 3, 5 }, tile::Scheme::SlippyMap }) == "213");
+        CHECK(quadkey({ 3, { 3, 2 } }) == "213");
+        CHECK(quadkey({ 0, { 0, 0 } }).empty());
+
+        tile::Id id;
+        const std::string key = "213";
+        const auto result = tile::from_quadkey(key.data(), key.data() + key.size(), id);
+        CHECK(result.ec == std::errc());
+        CHECK(result.ptr == key.data() + key.size());
+        CHECK(id == tile::Id { 3, { 3, 2 } });
+
+        for (unsigned zoom = 0; zoom < 8; ++zoom) {
+            for (unsigned y = 0; y < (1u << zoom); y += 3) {
+                for (unsigned x = 0; x < (1u << zoom); x += 5) {
+                    const auto original = tile::Id { zoom, { x, y }, tile::Scheme::SlippyMap };
+                    const auto k = quadkey(original);
+                    tile::Id parsed;
+                    tile::from_quadkey(k.data(), k.data() + k.size(), parsed, tile::Scheme::SlippyMap);
+                    CHECK(parsed == original);
+                }
+            }
+        }
+        const std::string too_long(32, '0');
+        CHECK(tile::from_quadkey(too_long.data(), too_long.data() + too_long.size(), id).ec == std::errc::result_out_of_range);
+    }
+}
+
+TEST_CASE("radix/tile: formatting performance")
+{
+    std::vector<tile::Id> ids;
+    for (unsigned i = 0; i < 100'000; ++i)
+        ids.push_back({ 16, { i % 65536, (i * 7) % 65536 } });
+    BENCHMARK("to_string (100k ids)")
+    {
+        size_t length = 0;
+        for (const auto& id : ids)
+            length += (std::to_string(id.zoom_level) + "/" + std::to_string(id.coords.x) + "/" + std::to_string(id.coords.y)).size();
+        return length;
+    };
+    BENCHMARK("to_chars (100k ids)")
+    {
+        size_t length = 0;
+        std::array<char, tile::max_zxy_chars> buffer;
+        for (const auto& id : ids)
+            length += size_t(tile::to_chars(buffer.data(), buffer.data() + buffer.size(), id).ptr - buffer.data());
+        return length;
+    };
+}
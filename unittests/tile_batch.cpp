@@ -0,0 +1,207 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <radix/tile_batch.h>
+
+using namespace radix;
+
+namespace {
+const auto world = srs::tile_bounds({ 0, { 0, 0 } }, srs::epsg_web_mercator);
+
+// clustered around a few centres, like gps tracks
+std::vector<glm::dvec2> random_points(size_t n)
+{
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> centre(world.min.x, world.max.x);
+    std::normal_distribution<double> offset(0, 50'000);
+    std::vector<glm::dvec2> centres;
+    for (int i = 0; i < 20; ++i)
+        centres.emplace_back(centre(rng), centre(rng) * 0.8);
+    std::vector<glm::dvec2> points;
+    points.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        points.push_back(centres[i % centres.size()] + glm::dvec2(offset(rng), offset(rng)));
+    return points;
+}
+
+tile::IdMap<std::vector<uint32_t>> reference_buckets(const std::vector<glm::dvec2>& points, unsigned zoom_level)
+{
+    tile::IdMap<std::vector<uint32_t>> buckets;
+    const auto size = world.size() / double(1u << zoom_level);
+    for (size_t i = 0; i < points.size(); ++i) {
+        const auto coords = glm::uvec2((points[i] - world.min) / size);
+        buckets[tile::Id { zoom_level, coords }].push_back(uint32_t(i));
+    }
+    return buckets;
+}
+} // namespace
+
+TEST_CASE("radix/tile_batch")
+{
+    SECTION("to_ids")
+    {
+        const auto points = random_points(1001);
+        for (const auto scheme : { tile::Scheme::Tms, tile::Scheme::SlippyMap }) {
+            std::vector<tile::Id> ids(points.size());
+            tile::to_ids(points, 10, scheme, world, ids);
+            std::vector<glm::uvec2> coords(points.size());
+            tile::to_coords(points, 10, scheme, world, coords);
+            for (size_t i = 0; i < points.size(); ++i) {
+                const auto bounds = srs::tile_bounds(ids[i], srs::epsg_web_mercator);
+                CHECK(bounds.contains(points[i]));
+                CHECK(ids[i].zoom_level == 10);
+                CHECK(ids[i].scheme == scheme);
+                CHECK(ids[i].coords == coords[i]);
+            }
+        }
+    }
+
+    SECTION("clamping")
+    {
+        const auto points = std::vector<glm::dvec2> { world.min - 1.0, world.max + 1.0, world.max, glm::dvec2(std::nan(""), 1.0), world.min, world.min };
+        std::vector<glm::uvec2> coords(points.size());
+        tile::to_coords(points, 3, tile::Scheme::Tms, world, coords);
+        CHECK(coords[0] == glm::uvec2(0, 0));
+        CHECK(coords[1] == glm::uvec2(7, 7));
+        CHECK(coords[2] == glm::uvec2(7, 7));
+        CHECK(coords[3] == glm::uvec2(0, 4));
+        CHECK(coords[4] == glm::uvec2(0, 0));
+
+        tile::to_coords(points, 31, tile::Scheme::Tms, world, coords);
+        const auto max_coord = (1u << 31) - 1;
+        CHECK(coords[0] == glm::uvec2(0, 0));
+        CHECK(coords[1] == glm::uvec2(max_coord, max_coord));
+        CHECK(coords[2] == glm::uvec2(max_coord, max_coord));
+        CHECK(coords[3] == glm::uvec2(0, unsigned((1.0 - world.min.y) * double(1u << 31) / world.size().y)));
+    }
+
+    SECTION("bucket_points")
+    {
+        const auto points = random_points(10'000);
+        const auto buckets = tile::bucket_points(points, 9);
+        const auto reference = reference_buckets(points, 9);
+        REQUIRE(buckets.size() == reference.size());
+        REQUIRE(buckets.offsets.size() == buckets.size() + 1);
+        CHECK(buckets.offsets.back() == points.size());
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            REQUIRE(reference.contains(buckets.ids[i]));
+            const auto bucket = buckets.points(i);
+            const auto& expected = reference.at(buckets.ids[i]);
+            CHECK(std::vector<uint32_t>(bucket.begin(), bucket.end()) == expected);
+            if (i > 0)
+                CHECK(morton::encode(buckets.ids[i - 1].coords) < morton::encode(buckets.ids[i].coords));
+        }
+
+        const auto empty = tile::bucket_points({}, 9);
+        CHECK(empty.size() == 0);
+        CHECK(empty.offsets.size() == 1);
+    }
+}
+
+TEST_CASE("radix/tile_batch: scheme conversion and quad positions")
+{
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<unsigned> zoom(0, 31);
+    std::uniform_int_distribution<unsigned> coord;
+    std::vector<tile::Id> ids;
+    for (int i = 0; i < 1003; ++i) {
+        const auto z = zoom(rng);
+        const auto mask = unsigned((uint64_t(1) << z) - 1);
+        ids.push_back({ z, { coord(rng) & mask, coord(rng) & mask }, i % 3 ? tile::Scheme::Tms : tile::Scheme::SlippyMap });
+    }
+
+    std::vector<tile::QuadPosition> positions(ids.size());
+    tile::quad_positions(ids, positions);
+    for (size_t i = 0; i < ids.size(); ++i)
+        CHECK(positions[i] == tile::quad_position(ids[i]));
+
+    for (const auto scheme : { tile::Scheme::SlippyMap, tile::Scheme::Tms }) {
+        auto converted = ids;
+        tile::to_scheme(converted, scheme);
+        for (size_t i = 0; i < ids.size(); ++i)
+            CHECK(converted[i] == ids[i].to(scheme));
+    }
+
+    // structure of arrays
+    for (const auto scheme : { tile::Scheme::SlippyMap, tile::Scheme::Tms }) {
+        std::vector<unsigned> zoom_levels;
+        std::vector<unsigned> xs;
+        std::vector<unsigned> ys;
+        for (const auto& id : ids) {
+            zoom_levels.push_back(id.zoom_level);
+            xs.push_back(id.coords.x);
+            ys.push_back(id.coords.y);
+        }
+        tile::quad_positions(xs, ys, scheme, positions);
+        for (size_t i = 0; i < ids.size(); ++i)
+            CHECK(positions[i] == tile::quad_position({ ids[i].zoom_level, ids[i].coords, scheme }));
+
+        const auto other = scheme == tile::Scheme::Tms ? tile::Scheme::SlippyMap : tile::Scheme::Tms;
+        tile::to_scheme(zoom_levels, ys, scheme, other);
+        for (size_t i = 0; i < ids.size(); ++i)
+            CHECK(ys[i] == tile::Id { ids[i].zoom_level, ids[i].coords, scheme }.to(other).coords.y);
+        tile::to_scheme(zoom_levels, ys, other, other);
+        tile::to_scheme(zoom_levels, ys, other, scheme);
+        for (size_t i = 0; i < ids.size(); ++i)
+            CHECK(ys[i] == ids[i].coords.y);
+    }
+}
+
+TEST_CASE("radix/tile_batch: performance")
+{
+    const auto points = random_points(1'000'000);
+    BENCHMARK("IdMap<std::vector> (1e6 points)")
+    {
+        return reference_buckets(points, 14).size();
+    };
+    BENCHMARK("bucket_points (1e6 points)")
+    {
+        return tile::bucket_points(points, 14).size();
+    };
+
+    std::vector<tile::Id> ids(points.size());
+    tile::to_ids(points, 14, tile::Scheme::Tms, world, ids);
+    BENCHMARK("Id::to (1e6 ids)")
+    {
+        for (auto& id : ids)
+            id = id.to(id.scheme == tile::Scheme::Tms ? tile::Scheme::SlippyMap : tile::Scheme::Tms);
+        return ids.back();
+    };
+    BENCHMARK("to_scheme (1e6 ids)")
+    {
+        tile::to_scheme(ids, ids.front().scheme == tile::Scheme::Tms ? tile::Scheme::SlippyMap : tile::Scheme::Tms);
+        return ids.back();
+    };
+
+    std::vector<unsigned> zoom_levels(ids.size(), 14);
+    std::vector<unsigned> ys;
+    for (const auto& id : ids)
+        ys.push_back(id.coords.y);
+    BENCHMARK("to_scheme, structure of arrays (1e6 ids)")
+    {
+        tile::to_scheme(zoom_levels, ys, tile::Scheme::Tms, tile::Scheme::SlippyMap);
+        return ys.back();
+    };
+}
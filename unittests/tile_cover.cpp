@@ -0,0 +1,183 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <radix/tile_cover.h>
+
+using namespace radix;
+
+namespace {
+std::vector<tile::Id> brute_force(const tile::SrsBounds& region, unsigned zoom_level, tile::Scheme scheme, int srs_epsg = srs::epsg_web_mercator)
+{
+    std::vector<tile::Id> ids;
+    const auto n = srs::root_tiles(srs_epsg) * (1u << zoom_level);
+    for (unsigned y = 0; y < n.y; ++y) {
+        for (unsigned x = 0; x < n.x; ++x) {
+            const auto id = tile::Id { zoom_level, { x, y }, scheme };
+            const auto bounds = srs::tile_bounds(id, srs_epsg);
+            if (bounds.min.x < region.max.x && bounds.max.x > region.min.x && bounds.min.y < region.max.y && bounds.max.y > region.min.y)
+                ids.push_back(id);
+        }
+    }
+    return ids;
+}
+} // namespace
+
+static_assert(std::forward_iterator<tile::Cover::Iterator>);
+
+TEST_CASE("radix/morton")
+{
+    CHECK(morton::encode({ 0, 0 }) == 0);
+    CHECK(morton::encode({ 1, 0 }) == 1);
+    CHECK(morton::encode({ 0, 1 }) == 2);
+    CHECK(morton::encode({ 3, 5 }) == 0b100111);
+    CHECK(morton::encode({ 0xFFFF'FFFF, 0xFFFF'FFFF }) == 0xFFFF'FFFF'FFFF'FFFFull);
+
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<unsigned> coord;
+    for (int i = 0; i < 1000; ++i) {
+        const auto coords = glm::uvec2(coord(rng), coord(rng));
+        CHECK(morton::decode(morton::encode(coords)) == coords);
+    }
+
+    // next_in_rect against a linear scan
+    std::uniform_int_distribution<unsigned> small(0, 31);
+    for (int i = 0; i < 200; ++i) {
+        auto a = glm::uvec2(small(rng), small(rng));
+        auto b = glm::uvec2(small(rng), small(rng));
+        const auto min = morton::encode(glm::min(a, b));
+        const auto max = morton::encode(glm::max(a, b));
+        for (uint64_t code = 0; code < max; ++code) {
+            if (morton::in_rect(code, min, max))
+                continue;
+            auto expected = code + 1;
+            while (!morton::in_rect(expected, min, max))
+                ++expected;
+            CHECK(morton::next_in_rect(code, min, max) == expected);
+        }
+    }
+}
+
+TEST_CASE("radix/tile_cover")
+{
+    const auto world = srs::tile_bounds({ 0, { 0, 0 } }, srs::epsg_web_mercator);
+
+    SECTION("whole world")
+    {
+        const auto ids = tile::cover(world, 2);
+        CHECK(ids.size() == 16);
+        CHECK(std::distance(ids.begin(), ids.end()) == 16);
+        CHECK(*ids.begin() == tile::Id { 2, { 0, 0 } });
+    }
+
+    SECTION("empty")
+    {
+        CHECK(tile::cover({ { 1e8, 1e8 }, { 2e8, 2e8 } }, 3).empty());
+        CHECK(tile::cover({ { 1e8, 1e8 }, { 2e8, 2e8 } }, 3).begin() == tile::cover({ { 1e8, 1e8 }, { 2e8, 2e8 } }, 3).end());
+        CHECK(tile::cover({ { 0.0, 0.0 }, { std::nan(""), 1.0 } }, 3).empty());
+    }
+
+    SECTION("max edges are exclusive")
+    {
+        // touching the root from the outside
+        CHECK(tile::cover({ world.max, world.max + 1000.0 }, 3).empty());
+        CHECK(tile::cover({ { world.max.x, 0.0 }, { world.max.x + 1000.0, 1000.0 } }, 3).empty());
+        CHECK(tile::cover({ world.min - 1000.0, world.min }, 3).empty());
+        // a point on the min corner is inside
+        CHECK(tile::cover({ world.min, world.min }, 3).size() == 1);
+        // a region ending on a tile edge doesn't include the tile starting there
+        const auto ids = tile::cover({ world.min, world.centre() }, 1);
+        REQUIRE(ids.size() == 1);
+        CHECK(*ids.begin() == tile::Id { 1, { 0, 0 } });
+    }
+
+    SECTION("EPSG:4326 has two tiles on zoom level 0")
+    {
+        const auto whole_world = tile::cover({ { -180.0, -90.0 }, { 180.0, 90.0 } }, 1, tile::Scheme::Tms, srs::epsg_wgs84);
+        CHECK(whole_world.size() == 8);
+        CHECK(whole_world.max() == glm::uvec2(3, 1));
+
+        std::mt19937 rng(2);
+        std::uniform_real_distribution<double> longitude(-200, 200);
+        std::uniform_real_distribution<double> latitude(-100, 100);
+        for (int i = 0; i < 50; ++i) {
+            const auto a = glm::dvec2(longitude(rng), latitude(rng));
+            const auto b = glm::dvec2(longitude(rng), latitude(rng));
+            const auto region = tile::SrsBounds { glm::min(a, b), glm::max(a, b) };
+            const auto zoom_level = unsigned(i % 5);
+            const auto scheme = i % 2 ? tile::Scheme::Tms : tile::Scheme::SlippyMap;
+            const auto ids = tile::cover(region, zoom_level, scheme, srs::epsg_wgs84, tile::CoverOrder::Morton);
+            auto expected = brute_force(region, zoom_level, scheme, srs::epsg_wgs84);
+            std::sort(expected.begin(), expected.end(), [](const tile::Id& a, const tile::Id& b) { return morton::encode(a.coords) < morton::encode(b.coords); });
+            CHECK(std::vector<tile::Id>(ids.begin(), ids.end()) == expected);
+        }
+    }
+
+    SECTION("a point is covered by one tile")
+    {
+        const auto ids = tile::cover({ { 1000.0, -1000.0 }, { 1000.0, -1000.0 } }, 4, tile::Scheme::SlippyMap);
+        REQUIRE(ids.size() == 1);
+        CHECK(*ids.begin() == tile::Id { 4, { 8, 8 }, tile::Scheme::SlippyMap });
+    }
+
+    SECTION("same tiles as brute force, in the requested order")
+    {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<double> coord(world.min.x * 1.1, world.max.x * 1.1);
+        for (int i = 0; i < 50; ++i) {
+            const auto a = glm::dvec2(coord(rng), coord(rng));
+            const auto b = glm::dvec2(coord(rng), coord(rng));
+            const auto region = tile::SrsBounds { glm::min(a, b), glm::max(a, b) };
+            const auto zoom_level = unsigned(i % 6);
+            const auto scheme = i % 2 ? tile::Scheme::Tms : tile::Scheme::SlippyMap;
+
+            auto expected = brute_force(region, zoom_level, scheme);
+            const auto row_major = tile::cover(region, zoom_level, scheme);
+            std::vector<tile::Id> ids(row_major.begin(), row_major.end());
+            CHECK(ids.size() == row_major.size());
+            const auto by_row = [](const tile::Id& a, const tile::Id& b) { return std::tie(a.coords.y, a.coords.x) < std::tie(b.coords.y, b.coords.x); };
+            std::sort(expected.begin(), expected.end(), by_row);
+            CHECK(ids == expected);
+
+            const auto morton_order = tile::cover(region, zoom_level, scheme, world, tile::CoverOrder::Morton);
+            ids.assign(morton_order.begin(), morton_order.end());
+            const auto by_morton = [](const tile::Id& a, const tile::Id& b) { return morton::encode(a.coords) < morton::encode(b.coords); };
+            std::sort(expected.begin(), expected.end(), by_morton);
+            CHECK(ids == expected);
+        }
+    }
+
+    SECTION("deep zoom levels are cheap")
+    {
+        const auto region = tile::SrsBounds { { 1'820'000.0, 6'140'000.0 }, { 1'825'000.0, 6'145'000.0 } };
+        const auto ids = tile::cover(region, 20, tile::Scheme::Tms, world, tile::CoverOrder::Morton);
+        size_t n = 0;
+        for (const auto& id : ids) {
+            CHECK(id.zoom_level == 20);
+            ++n;
+        }
+        CHECK(n == ids.size());
+        CHECK(n > 10'000);
+    }
+}
@@ -21,6 +21,7 @@
 #include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <radix/TileHeights.h>
+#include <radix/height_encoding.h>
 #include <radix/quad_tree.h>
 
 using namespace radix;
@@ -77,6 +78,32 @@ TEST_CASE("radix/TileHeights emplace and query")
         }
     }
 }
+
+TEST_CASE("radix/TileHeights emplace from an encoded tile")
+{
+    const auto tile = tile::Descriptor { { 3, { 2, 5 } }, {}, 3857, 64, 65 };
+    std::vector<float> heights(65 * 65, 1000.f);
+    heights[0] = 500.f;
+    heights.back() = 2000.f; // border sample
+    std::vector<glm::u8vec3> rgb(heights.size());
+    height_encoding::encode(heights, rgb);
+
+    TileHeights d;
+    std::vector<float> decoded(heights.size());
+    const auto [min, max] = d.emplace(tile, rgb, decoded);
+    CHECK(min == 500.f);
+    CHECK(max == 2000.f);
+    CHECK(d.query(tile.id) == std::make_pair(500.f, 2000.f));
+    CHECK(decoded == heights);
+
+    const auto no_border = tile::Descriptor { { 3, { 2, 4 } }, {}, 3857, 64, 64 };
+    heights.resize(64 * 64);
+    rgb.resize(64 * 64);
+    height_encoding::encode(heights, rgb);
+    d.emplace(no_border, rgb);
+    CHECK(d.query(no_border.id) == std::make_pair(500.f, 1000.f));
+}
+
 TEST_CASE("radix/TileHeights query performance")
 {
     TileHeights tile_heights;
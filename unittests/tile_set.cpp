@@ -0,0 +1,211 @@
+/*****************************************************************************
+ * Alpine Radix
+ * Copyright (C) 2024 alpinemaps.org
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <radix/TileSet.h>
+#include <radix/iterator.h>
+
+using namespace radix;
+
+namespace {
+// tiles around a moving camera, roughly what the renderer needs in a frame
+std::vector<tile::Id> frame_tiles(unsigned frame, size_t n)
+{
+    std::mt19937 rng(frame);
+    std::uniform_int_distribution<unsigned> zoom(10, 16);
+    std::normal_distribution<double> offset(0, 20);
+    std::vector<tile::Id> ids;
+    for (size_t i = 0; i < n; ++i) {
+        const auto z = zoom(rng);
+        const auto centre = glm::dvec2(1000.0 + frame, 2000.0) * double(1u << (z - 10));
+        ids.push_back({ z, glm::uvec2(glm::max(centre + glm::dvec2(offset(rng), offset(rng)), glm::dvec2(0.0))) });
+    }
+    return ids;
+}
+
+tile::IdSet to_id_set(const TileSet& set) { return { set.begin(), set.end() }; }
+} // namespace
+
+TEST_CASE("radix/TileSet")
+{
+    SECTION("insert, contains, erase")
+    {
+        TileSet set;
+        CHECK(set.empty());
+        set.insert({ 3, { 1, 2 } });
+        set.insert({ 1, { 0, 1 } });
+        set.insert({ 3, { 1, 2 } });
+        set.insert({ 2, { 3, 3 }, tile::Scheme::SlippyMap }); // stored as Tms
+        CHECK(set.size() == 3);
+        CHECK(set.contains({ 3, { 1, 2 } }));
+        CHECK(set.contains({ 2, { 3, 0 } }));
+        CHECK(set.contains({ 2, { 3, 3 }, tile::Scheme::SlippyMap }));
+        CHECK(!set.contains({ 3, { 2, 1 } }));
+        CHECK(std::vector<tile::Id>(set.begin(), set.end()) == std::vector<tile::Id> { { 1, { 0, 1 } }, { 2, { 3, 0 } }, { 3, { 1, 2 } } });
+
+        set.erase({ 2, { 3, 0 } });
+        set.erase({ 5, { 0, 0 } });
+        CHECK(set.size() == 2);
+        CHECK(!set.contains({ 2, { 3, 0 } }));
+        set.clear();
+        CHECK(set.empty());
+    }
+
+    SECTION("bulk construction matches IdSet")
+    {
+        const auto ids = frame_tiles(0, 5000);
+        const auto set = TileSet(ids);
+        const auto expected = tile::IdSet(ids.begin(), ids.end());
+        CHECK(set.size() == expected.size());
+        CHECK(to_id_set(set) == expected);
+        CHECK(std::is_sorted(set.begin(), set.end()));
+        CHECK(TileSet(expected) == set);
+
+        TileSet inserted;
+        std::copy(ids.begin(), ids.end(), unordered_inserter(inserted));
+        CHECK(inserted == set);
+    }
+
+    SECTION("set operations match IdSet")
+    {
+        const auto a_ids = frame_tiles(0, 3000);
+        const auto b_ids = frame_tiles(5, 3000);
+        const auto a = TileSet(a_ids);
+        const auto b = TileSet(b_ids);
+        const auto a_set = tile::IdSet(a_ids.begin(), a_ids.end());
+        const auto b_set = tile::IdSet(b_ids.begin(), b_ids.end());
+
+        tile::IdSet expected_union = a_set;
+        expected_union.insert(b_set.begin(), b_set.end());
+        tile::IdSet expected_difference;
+        tile::IdSet expected_intersection;
+        for (const auto& id : a_set) {
+            if (b_set.contains(id))
+                expected_intersection.insert(id);
+            else
+                expected_difference.insert(id);
+        }
+        REQUIRE(!expected_difference.empty());
+        REQUIRE(!expected_intersection.empty());
+        CHECK(to_id_set(set_union(a, b)) == expected_union);
+        CHECK(to_id_set(set_difference(a, b)) == expected_difference);
+        CHECK(to_id_set(set_intersection(a, b)) == expected_intersection);
+        CHECK(set_intersection(a, TileSet()).empty());
+        CHECK(set_union(a, TileSet()) == a);
+    }
+}
+
+TEST_CASE("radix/TileSet: performance")
+{
+    const auto needed_ids = frame_tiles(10, 20'000);
+    const auto loaded_ids = frame_tiles(11, 20'000);
+    BENCHMARK("IdSet frame diff (20k tiles)")
+    {
+        tile::IdSet needed;
+        std::copy(needed_ids.begin(), needed_ids.end(), unordered_inserter(needed));
+        tile::IdSet loaded;
+        std::copy(loaded_ids.begin(), loaded_ids.end(), unordered_inserter(loaded));
+        tile::IdSet to_load;
+        tile::IdSet to_unload;
+        std::copy_if(needed.begin(), needed.end(), unordered_inserter(to_load), [&](const auto& id) { return !loaded.contains(id); });
+        std::copy_if(loaded.begin(), loaded.end(), unordered_inserter(to_unload), [&](const auto& id) { return !needed.contains(id); });
+        return to_load.size() + to_unload.size();
+    };
+    BENCHMARK("TileSet frame diff (20k tiles)")
+    {
+        TileSet needed;
+        std::copy(needed_ids.begin(), needed_ids.end(), unordered_inserter(needed));
+        TileSet loaded;
+        std::copy(loaded_ids.begin(), loaded_ids.end(), unordered_inserter(loaded));
+        return set_difference(needed, loaded).size() + set_difference(loaded, needed).size();
+    };
+}
+
+TEST_CASE("radix/TileSet: compact and expand_to_zoom")
+{
+    SECTION("complete quads are replaced recursively")
+    {
+        TileSet set;
+        for (const auto& child : tile::Id { 1, { 1, 1 } }.children()) {
+            for (const auto& grand_child : child.children())
+                set.insert(grand_child);
+        }
+        set.insert({ 3, { 0, 0 } });
+        set.insert({ 4, { 0, 0 } }); // covered by 3/0/0
+        set.insert({ 5, { 20, 20 } }); // covered by 1/1/1
+        const auto compacted = compact(set);
+        CHECK(std::vector<tile::Id>(compacted.begin(), compacted.end()) == std::vector<tile::Id> { { 1, { 1, 1 } }, { 3, { 0, 0 } } });
+
+        TileSet root_quad(tile::Scheme::SlippyMap);
+        for (const auto& child : tile::Id { 0, { 0, 0 }, tile::Scheme::SlippyMap }.children())
+            root_quad.insert(child);
+        const auto root = compact(root_quad);
+        CHECK(root.scheme() == tile::Scheme::SlippyMap);
+        CHECK(std::vector<tile::Id>(root.begin(), root.end()) == std::vector<tile::Id> { { 0, { 0, 0 }, tile::Scheme::SlippyMap } });
+
+        CHECK(compact(TileSet()).empty());
+    }
+
+    SECTION("expand_to_zoom")
+    {
+        TileSet set;
+        set.insert({ 1, { 0, 0 } });
+        set.insert({ 3, { 7, 7 } });
+        set.insert({ 3, { 6, 7 } }); // same ancestor on level 2
+        set.insert({ 2, { 0, 0 } }); // covered
+        const auto expanded = expand_to_zoom(set, 2);
+        CHECK(std::vector<tile::Id>(expanded.begin(), expanded.end())
+            == std::vector<tile::Id> { { 2, { 0, 0 } }, { 2, { 0, 1 } }, { 2, { 1, 0 } }, { 2, { 1, 1 } }, { 2, { 3, 3 } } });
+    }
+
+    SECTION("random sets: same area, minimal")
+    {
+        constexpr unsigned max_zoom = 7;
+        std::mt19937 rng(3);
+        for (int i = 0; i < 20; ++i) {
+            // dense region, so that there are many complete quads
+            TileSet set;
+            std::uniform_int_distribution<unsigned> zoom(2, max_zoom);
+            std::uniform_int_distribution<unsigned> coord(0, 127);
+            for (int j = 0; j < 3000; ++j) {
+                const auto z = zoom(rng);
+                const auto mask = (1u << z) - 1;
+                set.insert({ z, { (coord(rng) >> (max_zoom - z)) & mask, (coord(rng) / 2 >> (max_zoom - z)) & mask } });
+            }
+            const auto compacted = compact(set);
+            CHECK(compacted.size() <= set.size());
+            CHECK(expand_to_zoom(compacted, max_zoom) == expand_to_zoom(set, max_zoom));
+            CHECK(compact(compacted) == compacted);
+            for (const auto& id : compacted) {
+                // no complete quad and no covered tile is left
+                if (id.zoom_level > 0) {
+                    const auto siblings = id.parent().children();
+                    CHECK(!std::all_of(siblings.begin(), siblings.end(), [&](const auto& s) { return compacted.contains(s); }));
+                    for (auto ancestor = id.parent(); ancestor.zoom_level != unsigned(-1); ancestor = ancestor.parent())
+                        CHECK(!compacted.contains(ancestor));
+                }
+            }
+        }
+    }
+}